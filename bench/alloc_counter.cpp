@@ -0,0 +1,137 @@
+// Preloaded into a benchmarked process via LD_PRELOAD. Counts calls of
+// operator new and prints the amount to a file from YTTO_BENCH_ALLOC_FILE on
+// exit. operator new of the preloaded library interposes the one of
+// libstdc++, since the executable does not define its own.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<unsigned long long> allocations{0};
+    std::atomic<unsigned long long> allocated_bytes{0};
+
+    void* counted_malloc(std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* counted_aligned(std::size_t size, std::align_val_t align)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        auto alignment = static_cast<std::size_t>(align);
+        return std::aligned_alloc(
+            alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    struct Reporter
+    {
+        Reporter(Reporter const&) = delete;
+        Reporter& operator=(Reporter const&) = delete;
+        Reporter() = default;
+
+        ~Reporter()
+        {
+            char const* path = std::getenv("YTTO_BENCH_ALLOC_FILE");
+            if (path == nullptr)
+                {
+                    return;
+                }
+            std::FILE* file = std::fopen(path, "w");
+            if (file == nullptr)
+                {
+                    return;
+                }
+            std::fprintf(file, "%llu %llu\n", allocations.load(),
+                         allocated_bytes.load());
+            std::fclose(file);
+        }
+    };
+
+    Reporter reporter;
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    void* ptr = counted_malloc(size);
+    if (ptr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return counted_malloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    void* ptr = counted_aligned(size, align);
+    if (ptr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
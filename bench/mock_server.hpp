@@ -0,0 +1,275 @@
+#ifndef BENCH_MOCK_SERVER_HPP_
+#define BENCH_MOCK_SERVER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/hash2/hash_append.hpp>
+#include <boost/hash2/xxhash.hpp>
+#include <boost/url.hpp>
+#include <fmt/format.h>
+
+namespace bench
+{
+    namespace beast = boost::beast;
+    namespace http = beast::http;
+    namespace net = boost::asio;
+
+    struct MockServerOptions
+    {
+        // Time before the first byte of a response of the LLM.
+        std::chrono::milliseconds llm_latency{0};
+        // 0 means a response with Content-Length. Otherwise the response is
+        // sent with chunked transfer encoding in that many chunks with
+        // `llm_chunk_delay` between them, like a streaming generation.
+        size_t llm_stream_chunks = 0;
+        std::chrono::milliseconds llm_chunk_delay{0};
+        size_t llm_response_bytes = 2048;
+    };
+
+    inline std::string lorem(size_t bytes)
+    {
+        static constexpr std::string_view words
+            = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do "
+              "eiusmod tempor incididunt ut labore et dolore magna aliqua ";
+        std::string res;
+        res.reserve(bytes);
+        while (res.size() < bytes)
+            {
+                res.append(words.substr(
+                    0, std::min(words.size(), bytes - res.size())));
+            }
+        return res;
+    }
+
+    /// 11 characters of YouTube's video id derived from a channel and an
+    /// index of an entry, so that different channels never share videos.
+    inline std::string video_id(std::string_view channel_id, size_t index)
+    {
+        static constexpr std::string_view alphabet
+            = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        boost::hash2::xxhash_64 hash_object;
+        boost::hash2::hash_append(hash_object, {}, channel_id);
+        boost::hash2::hash_append(hash_object, {}, index);
+        std::uint64_t hash = hash_object.result();
+        std::string id;
+        for (int i = 0; i < 11; ++i)
+            {
+                id.push_back(alphabet[hash % alphabet.size()]);
+                hash /= alphabet.size();
+            }
+        return id;
+    }
+
+    /// Something that looks like https://www.youtube.com/feeds/videos.xml
+    inline std::string synthetic_feed(std::string_view channel_id,
+                                      size_t entries)
+    {
+        std::string res = fmt::format(
+            R"(<?xml version="1.0" encoding="UTF-8"?>
+<feed xmlns:yt="http://www.youtube.com/xml/schemas/2015" xmlns:media="http://search.yahoo.com/mrss/" xmlns="http://www.w3.org/2005/Atom">
+ <link rel="self" href="http://www.youtube.com/feeds/videos.xml?channel_id={0}"/>
+ <id>yt:channel:{0}</id>
+ <yt:channelId>{0}</yt:channelId>
+ <title>Bench channel {0}</title>
+ <author>
+  <name>Bench author</name>
+  <uri>https://www.youtube.com/channel/{0}</uri>
+ </author>
+ <published>2020-01-01T00:00:00+00:00</published>
+)",
+            channel_id);
+        for (size_t i = 0; i < entries; ++i)
+            {
+                std::string id = video_id(channel_id, i);
+                fmt::format_to(
+                    std::back_inserter(res),
+                    R"( <entry>
+  <id>yt:video:{0}</id>
+  <yt:videoId>{0}</yt:videoId>
+  <yt:channelId>{1}</yt:channelId>
+  <title>Video number {2}</title>
+  <link rel="alternate" href="https://www.youtube.com/watch?v={0}"/>
+  <author>
+   <name>Bench author</name>
+   <uri>https://www.youtube.com/channel/{1}</uri>
+  </author>
+  <published>2025-01-{3:02}T00:00:00+00:00</published>
+  <updated>2025-01-{3:02}T00:00:00+00:00</updated>
+  <media:group>
+   <media:title>Video number {2}</media:title>
+   <media:content url="https://www.youtube.com/v/{0}?version=3" type="application/x-shockwave-flash" width="640" height="390"/>
+   <media:thumbnail url="https://i1.ytimg.com/vi/{0}/hqdefault.jpg" width="480" height="360"/>
+   <media:description>{4}</media:description>
+   <media:community>
+    <media:starRating count="100" average="5.00" min="1" max="5"/>
+    <media:statistics views="1000"/>
+   </media:community>
+  </media:group>
+ </entry>
+)",
+                    id, channel_id, i, 1 + i % 28, lorem(600));
+            }
+        res += "</feed>\n";
+        return res;
+    }
+
+    /**
+     * @class MockServer
+     * @brief Pretends to be both an Ollama instance (any POST) and
+     * YouTube's feeds (GET with `?channel_id=`). Thread per connection.
+     */
+    class MockServer
+    {
+        MockServerOptions options_;
+        net::io_context ioc_;
+        net::ip::tcp::acceptor acceptor_;
+        std::thread thread_;
+        // Touched only by thread_ and by the destructor after thread_ ended.
+        std::vector<std::thread> connections_;
+        std::atomic<bool> stopping_{false};
+        std::atomic<size_t> llm_requests_{0};
+        std::atomic<size_t> feed_entries_{15};
+        std::string llm_response_;
+
+      public:
+        explicit MockServer(MockServerOptions options)
+            : options_(options),
+              acceptor_(ioc_, {net::ip::make_address("127.0.0.1"), 0})
+        {
+            llm_response_ = fmt::format(
+                R"({{"model":"mock","created_at":"2025-01-01T00:00:00Z","message":{{"role":"assistant","content":"{}"}},"done_reason":"stop","done":true,"total_duration":1,"load_duration":1,"prompt_eval_count":1000,"prompt_eval_duration":1000000,"eval_count":100,"eval_duration":1000000}})",
+                lorem(options_.llm_response_bytes));
+            thread_ = std::thread([this] { accept_loop(); });
+        }
+
+        MockServer(MockServer const&) = delete;
+        MockServer& operator=(MockServer const&) = delete;
+
+        ~MockServer()
+        {
+            stopping_ = true;
+            // Wake up the blocking accept().
+            boost::system::error_code ec;
+            {
+                net::ip::tcp::socket waker(ioc_);
+                waker.connect(acceptor_.local_endpoint(), ec);
+            }
+            thread_.join();
+            for (std::thread& connection : connections_)
+                {
+                    connection.join();
+                }
+            acceptor_.close(ec);
+        }
+
+        [[nodiscard]] uint16_t port() const
+        {
+            return acceptor_.local_endpoint().port();
+        }
+
+        [[nodiscard]] size_t llm_requests() const { return llm_requests_; }
+
+        void set_feed_entries(size_t entries) { feed_entries_ = entries; }
+
+      private:
+        void accept_loop()
+        {
+            while (not stopping_)
+                {
+                    boost::system::error_code ec;
+                    net::ip::tcp::socket socket(ioc_);
+                    acceptor_.accept(socket, ec);
+                    if (ec)
+                        {
+                            continue;
+                        }
+                    connections_.emplace_back(
+                        [this, socket = std::move(socket)]() mutable
+                            { handle(std::move(socket)); });
+                }
+        }
+
+        void handle(net::ip::tcp::socket socket)
+        {
+            beast::flat_buffer buffer;
+            http::request<http::string_body> req;
+            boost::system::error_code ec;
+            http::read(socket, buffer, req, ec);
+            if (ec)
+                {
+                    return;
+                }
+
+            if (req.method() == http::verb::get)
+                {
+                    boost::urls::url_view target(req.target());
+                    auto params = target.params();
+                    auto channel = params.find("channel_id");
+                    http::response<http::string_body> res{http::status::ok,
+                                                           req.version()};
+                    res.set(http::field::content_type, "application/atom+xml");
+                    res.body() = synthetic_feed(
+                        channel == params.end() ? std::string("UCbench")
+                                                : (*channel).value,
+                        feed_entries_);
+                    res.prepare_payload();
+                    http::write(socket, res, ec);
+                }
+            else
+                {
+                    ++llm_requests_;
+                    std::this_thread::sleep_for(options_.llm_latency);
+                    if (options_.llm_stream_chunks == 0)
+                        {
+                            http::response<http::string_body> res{
+                                http::status::ok, req.version()};
+                            res.set(http::field::content_type,
+                                    "application/json");
+                            res.body() = llm_response_;
+                            res.prepare_payload();
+                            http::write(socket, res, ec);
+                        }
+                    else
+                        {
+                            write_chunked(socket, req.version());
+                        }
+                }
+            socket.shutdown(net::ip::tcp::socket::shutdown_both, ec);
+        }
+
+        void write_chunked(net::ip::tcp::socket& socket, unsigned version)
+        {
+            boost::system::error_code ec;
+            http::response<http::empty_body> res{http::status::ok, version};
+            res.set(http::field::content_type, "application/json");
+            res.chunked(true);
+            http::response_serializer<http::empty_body> serializer{res};
+            http::write_header(socket, serializer, ec);
+
+            size_t chunk_size = (llm_response_.size()
+                                 + options_.llm_stream_chunks - 1)
+                                / options_.llm_stream_chunks;
+            for (size_t pos = 0; pos < llm_response_.size() && !ec;
+                 pos += chunk_size)
+                {
+                    std::this_thread::sleep_for(options_.llm_chunk_delay);
+                    std::string_view chunk = std::string_view(llm_response_)
+                                                 .substr(pos, chunk_size);
+                    net::write(socket,
+                               http::make_chunk(net::buffer(chunk)), ec);
+                }
+            net::write(socket, http::make_chunk_last(), ec);
+        }
+    };
+
+}  // namespace bench
+
+#endif  // BENCH_MOCK_SERVER_HPP_
@@ -0,0 +1,742 @@
+// End-to-end benchmark of YoutubeToOllama without network: a mock LLM and
+// feed server in-process, a stub `yt-dlp` on PATH, and the real binary driven
+// in stdin mode and in server mode.
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "mock_server.hpp"
+#include "ytto/job_journal.hpp"
+
+namespace
+{
+    namespace beast = boost::beast;
+    namespace http = beast::http;
+    namespace net = boost::asio;
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+
+    struct BenchOptions
+    {
+        std::filesystem::path ytto = YTTO_BENCH_DEFAULT_BINARY;
+        std::filesystem::path alloc_library = YTTO_BENCH_ALLOC_LIBRARY;
+        std::filesystem::path work_dir;
+        std::vector<size_t> entries{5, 15, 50};
+        size_t runs = 3;
+        size_t clients = 4;
+        size_t requests = 32;
+        size_t llm_latency_ms = 200;
+        size_t llm_stream_chunks = 0;
+        size_t llm_chunk_delay_ms = 0;
+        size_t llm_response_bytes = 2048;
+        size_t subtitle_bytes = 20000;
+        size_t yt_dlp_delay_ms = 300;
+        size_t jobs_yt_dlp = 5;
+        size_t jobs_requests = 6;
+        bool yt_dlp_batch = false;
+        bool skip_stdin = false;
+        bool skip_server = false;
+        bool skip_checks = false;
+    };
+
+    struct ProcessStats
+    {
+        int exit_code = -1;
+        Seconds wall{};
+        long max_rss_kb = 0;
+        unsigned long long allocations = 0;
+        unsigned long long allocated_bytes = 0;
+        std::string out;
+    };
+
+    struct Process
+    {
+        pid_t pid = -1;
+        int stdin_fd = -1;
+        int stdout_fd = -1;
+        Clock::time_point started;
+    };
+
+    class Environment
+    {
+        BenchOptions const& options_;
+        std::filesystem::path stub_dir_;
+        std::filesystem::path alloc_file_;
+
+      public:
+        explicit Environment(BenchOptions const& options) : options_(options)
+        {
+            stub_dir_ = options.work_dir / "bin";
+            std::filesystem::create_directories(stub_dir_);
+            alloc_file_ = options.work_dir / "allocations.txt";
+
+            std::filesystem::path subtitles = options.work_dir / "subtitles.txt";
+            std::ofstream(subtitles) << bench::lorem(options.subtitle_bytes);
+
+            std::filesystem::path stub = stub_dir_ / "yt-dlp";
+            // ytto gives an output folder by -P and links; the stub writes
+            // a VTT file per link there and prints it like --exec of ytto
+            // does.
+            std::ofstream(stub) << fmt::format(
+                "#!/bin/sh\n"
+                "# Stub of yt-dlp for ytto_bench: ignores arguments but -P "
+                "and links.\n"
+                "sleep {0:.3f}\n"
+                "n=0\n"
+                "while [ $# -gt 0 ]; do\n"
+                "    case \"$1\" in\n"
+                "    -P) folder=$2; shift ;;\n"
+                "    http*)\n"
+                "        n=$((n + 1))\n"
+                "        {{ printf 'WEBVTT\\nKind: captions\\n"
+                "Language: en\\n\\n'; cat '{1}'; }} > \"$folder/$n.en.vtt\"\n"
+                "        echo \"$1 $folder/$n.en.vtt\"\n"
+                "        ;;\n"
+                "    esac\n"
+                "    shift\n"
+                "done\n",
+                static_cast<double>(options.yt_dlp_delay_ms) / 1000.,
+                subtitles.string());
+            std::filesystem::permissions(
+                stub, std::filesystem::perms::owner_all,
+                std::filesystem::perm_options::replace);
+        }
+
+        [[nodiscard]] std::vector<std::string> ytto_args(
+            std::filesystem::path const& cache_dir, uint16_t llm_port) const
+        {
+            std::vector<std::string> args{
+                options_.ytto.string(),
+                "-c",
+                (cache_dir / "summaries").string(),
+                "-S",
+                (cache_dir / "subtitles").string(),
+                "-l",
+                (cache_dir / "ytto.log").string(),
+                "-u",
+                fmt::format("http://127.0.0.1:{}/api/chat", llm_port),
+                "-j",
+                std::to_string(options_.jobs_yt_dlp),
+                "-J",
+                std::to_string(options_.jobs_requests)};
+            if (options_.yt_dlp_batch)
+                {
+                    args.emplace_back("--yt-dlp-batch");
+                }
+            return args;
+        }
+
+        [[nodiscard]] Process spawn(std::vector<std::string> const& args,
+                                    bool capture_stdio) const
+        {
+            std::array<int, 2> in_pipe{-1, -1};
+            std::array<int, 2> out_pipe{-1, -1};
+            if (capture_stdio
+                && (::pipe(in_pipe.data()) != 0 || ::pipe(out_pipe.data()) != 0))
+                {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "pipe");
+                }
+            std::filesystem::remove(alloc_file_);
+
+            Process process;
+            process.started = Clock::now();
+            process.pid = ::fork();
+            if (process.pid < 0)
+                {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "fork");
+                }
+            if (process.pid == 0)
+                {
+                    if (capture_stdio)
+                        {
+                            ::dup2(in_pipe[0], STDIN_FILENO);
+                            ::dup2(out_pipe[1], STDOUT_FILENO);
+                            ::close(in_pipe[0]);
+                            ::close(in_pipe[1]);
+                            ::close(out_pipe[0]);
+                            ::close(out_pipe[1]);
+                        }
+                    std::string path = stub_dir_.string();
+                    if (char const* old_path = std::getenv("PATH"))
+                        {
+                            path += ":";
+                            path += old_path;
+                        }
+                    ::setenv("PATH", path.c_str(), 1);
+                    if (not options_.alloc_library.empty())
+                        {
+                            ::setenv("LD_PRELOAD",
+                                     options_.alloc_library.c_str(), 1);
+                            ::setenv("YTTO_BENCH_ALLOC_FILE",
+                                     alloc_file_.c_str(), 1);
+                        }
+                    std::vector<char*> argv;
+                    for (std::string const& arg : args)
+                        {
+                            argv.push_back(const_cast<char*>(arg.c_str()));
+                        }
+                    argv.push_back(nullptr);
+                    ::execv(argv[0], argv.data());
+                    std::_Exit(127);
+                }
+            if (capture_stdio)
+                {
+                    ::close(in_pipe[0]);
+                    ::close(out_pipe[1]);
+                    process.stdin_fd = in_pipe[1];
+                    process.stdout_fd = out_pipe[0];
+                }
+            return process;
+        }
+
+        [[nodiscard]] ProcessStats wait(Process const& process) const
+        {
+            ProcessStats stats;
+            if (process.stdout_fd >= 0)
+                {
+                    std::array<char, 65536> buf{};
+                    for (;;)
+                        {
+                            ssize_t got
+                                = ::read(process.stdout_fd, buf.data(), buf.size());
+                            if (got <= 0)
+                                {
+                                    break;
+                                }
+                            stats.out.append(buf.data(),
+                                             static_cast<size_t>(got));
+                        }
+                    ::close(process.stdout_fd);
+                }
+
+            int status = 0;
+            rusage usage{};
+            ::wait4(process.pid, &status, 0, &usage);
+            stats.wall = Clock::now() - process.started;
+            stats.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            stats.max_rss_kb = usage.ru_maxrss;
+            std::ifstream(alloc_file_)
+                >> stats.allocations >> stats.allocated_bytes;
+            return stats;
+        }
+    };
+
+    void write_all(int fd, std::string_view data)
+    {
+        while (not data.empty())
+            {
+                ssize_t written = ::write(fd, data.data(), data.size());
+                if (written <= 0)
+                    {
+                        break;
+                    }
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+    }
+
+    size_t count_summaries(std::string_view feed)
+    {
+        size_t count = 0;
+        for (size_t pos = feed.find("LLM&apos;s result:");
+             pos != std::string_view::npos;
+             pos = feed.find("LLM&apos;s result:", pos + 1))
+            {
+                ++count;
+            }
+        return count;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            {
+                return 0.;
+            }
+        std::ranges::sort(values);
+        auto idx = static_cast<size_t>(
+            std::ceil(p * static_cast<double>(values.size())));
+        return values[std::clamp<size_t>(idx, 1, values.size()) - 1];
+    }
+
+    void print_row(std::string_view scenario, size_t entries,
+                   std::vector<double> const& latencies, Seconds total,
+                   size_t feeds, ProcessStats const& stats)
+    {
+        fmt::println(
+            "{:<14} {:>7} {:>9.2f} {:>9.3f} {:>9.3f} {:>10} {:>12} {:>10}",
+            scenario, entries,
+            static_cast<double>(feeds) / std::max(total.count(), 1e-9),
+            percentile(latencies, 0.5), percentile(latencies, 0.99),
+            stats.max_rss_kb, stats.allocations,
+            stats.allocated_bytes / 1024);
+    }
+
+    void bench_stdin(BenchOptions const& options, Environment const& env,
+                     bench::MockServer const& mock)
+    {
+        for (size_t entries : options.entries)
+            {
+                std::string feed = bench::synthetic_feed(
+                    "UCbenchbenchbenchbench00", entries);
+                std::filesystem::path cache_dir
+                    = options.work_dir / fmt::format("stdin-{}", entries);
+
+                std::vector<double> cold;
+                ProcessStats last_cold;
+                Seconds cold_total{};
+                for (size_t run = 0; run < options.runs; ++run)
+                    {
+                        std::filesystem::remove_all(cache_dir);
+                        Process process = env.spawn(
+                            env.ytto_args(cache_dir, mock.port()), true);
+                        write_all(process.stdin_fd, feed);
+                        ::close(process.stdin_fd);
+                        last_cold = env.wait(process);
+                        if (last_cold.exit_code != 0
+                            || count_summaries(last_cold.out) != entries)
+                            {
+                                fmt::println(std::cerr,
+                                             "stdin run failed: exit code {}, "
+                                             "{} of {} summaries",
+                                             last_cold.exit_code,
+                                             count_summaries(last_cold.out),
+                                             entries);
+                            }
+                        cold.push_back(last_cold.wall.count());
+                        cold_total += last_cold.wall;
+                    }
+                print_row("stdin cold", entries, cold, cold_total,
+                          options.runs, last_cold);
+
+                std::vector<double> warm;
+                ProcessStats last_warm;
+                Seconds warm_total{};
+                for (size_t run = 0; run < options.runs; ++run)
+                    {
+                        Process process = env.spawn(
+                            env.ytto_args(cache_dir, mock.port()), true);
+                        write_all(process.stdin_fd, feed);
+                        ::close(process.stdin_fd);
+                        last_warm = env.wait(process);
+                        warm.push_back(last_warm.wall.count());
+                        warm_total += last_warm.wall;
+                    }
+                print_row("stdin warm", entries, warm, warm_total,
+                          options.runs, last_warm);
+            }
+    }
+
+    uint16_t free_port()
+    {
+        net::io_context ioc;
+        net::ip::tcp::acceptor acceptor(
+            ioc, {net::ip::make_address("127.0.0.1"), 0});
+        return acceptor.local_endpoint().port();
+    }
+
+    bool wait_for_port(uint16_t port, std::chrono::seconds timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (Clock::now() < deadline)
+            {
+                net::io_context ioc;
+                net::ip::tcp::socket socket(ioc);
+                boost::system::error_code ec;
+                socket.connect({net::ip::make_address("127.0.0.1"), port}, ec);
+                if (not ec)
+                    {
+                        return true;
+                    }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        return false;
+    }
+
+    /// Latency of one feed requested from ytto's server, or a negative value
+    /// on a failure.
+    double request_feed(uint16_t port, std::string const& channel_id,
+                        size_t entries)
+    {
+        auto start = Clock::now();
+        net::io_context ioc;
+        beast::tcp_stream stream(ioc);
+        boost::system::error_code ec;
+        stream.connect({net::ip::make_address("127.0.0.1"), port}, ec);
+        if (ec)
+            {
+                return -1.;
+            }
+        http::request<http::string_body> req{http::verb::get, "/", 11};
+        req.set(http::field::host, "127.0.0.1");
+        req.body() = fmt::format(
+            R"({{"url":"https://www.youtube.com/feeds/videos.xml?channel_id={}"}})",
+            channel_id);
+        req.prepare_payload();
+        http::write(stream, req, ec);
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res, ec);
+        if (ec || res.result() != http::status::ok
+            || count_summaries(res.body()) != entries)
+            {
+                return -1.;
+            }
+        return Seconds(Clock::now() - start).count();
+    }
+
+    void bench_server(BenchOptions const& options, Environment const& env,
+                      bench::MockServer& mock)
+    {
+        for (size_t entries : options.entries)
+            {
+                mock.set_feed_entries(entries);
+                std::filesystem::path cache_dir
+                    = options.work_dir / fmt::format("server-{}", entries);
+                std::filesystem::remove_all(cache_dir);
+
+                uint16_t port = free_port();
+                std::vector<std::string> args
+                    = env.ytto_args(cache_dir, mock.port());
+                args.insert(args.end(),
+                            {"-A", "-p", std::to_string(port), "--feed-source",
+                             fmt::format("http://127.0.0.1:{}/feeds/videos.xml",
+                                         mock.port())});
+                Process process = env.spawn(args, false);
+                if (not wait_for_port(port, std::chrono::seconds(10)))
+                    {
+                        fmt::println(std::cerr, "ytto's server did not start");
+                        ::kill(process.pid, SIGKILL);
+                        (void)env.wait(process);
+                        continue;
+                    }
+
+                std::mutex mutex;
+                std::vector<double> latencies;
+                size_t failures = 0;
+                std::atomic<size_t> next{0};
+                auto started = Clock::now();
+                std::vector<std::thread> clients;
+                for (size_t c = 0; c < options.clients; ++c)
+                    {
+                        clients.emplace_back(
+                            [&]
+                                {
+                                    for (size_t i = next++;
+                                         i < options.requests; i = next++)
+                                        {
+                                            // 22 characters after "UC"
+                                            std::string channel = fmt::format(
+                                                "UCbench{:015}", i);
+                                            double latency = request_feed(
+                                                port, channel, entries);
+                                            std::scoped_lock lock(mutex);
+                                            if (latency < 0)
+                                                {
+                                                    ++failures;
+                                                }
+                                            else
+                                                {
+                                                    latencies.push_back(latency);
+                                                }
+                                        }
+                                });
+                    }
+                for (std::thread& client : clients)
+                    {
+                        client.join();
+                    }
+                Seconds total = Clock::now() - started;
+
+                ::kill(process.pid, SIGTERM);
+                ProcessStats stats = env.wait(process);
+                if (failures != 0)
+                    {
+                        fmt::println(std::cerr, "{} of {} requests failed",
+                                     failures, options.requests);
+                    }
+                print_row("server cold", entries, latencies, total,
+                          latencies.size(), stats);
+            }
+    }
+
+    /// Status of a POST of `body` to `target`, or 0 if there was no
+    /// response.
+    unsigned post(auto& stream, beast::string_view target, std::string body)
+    {
+        http::request<http::string_body> req{http::verb::post, target, 11,
+                                             std::move(body)};
+        req.set(http::field::host, "localhost");
+        req.set(http::field::content_type, "text/xml");
+        req.prepare_payload();
+        boost::system::error_code ec;
+        http::write(stream, req, ec);
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res, ec);
+        return ec ? 0 : res.result_int();
+    }
+
+    /// Posts broken feeds and checks that they are refused and that the
+    /// server survives them. Returns whether everything went as expected.
+    bool check_malformed_feeds(BenchOptions const& options,
+                               Environment const& env,
+                               bench::MockServer& mock)
+    {
+        std::filesystem::path cache_dir = options.work_dir / "malformed";
+        std::filesystem::remove_all(cache_dir);
+        std::filesystem::create_directories(cache_dir);
+        std::filesystem::path socket_path = cache_dir / "ytto.sock";
+
+        uint16_t port = free_port();
+        std::vector<std::string> args = env.ytto_args(cache_dir, mock.port());
+        args.insert(args.end(), {"-A", "-p", std::to_string(port),
+                                 "--daemon-socket", socket_path.string()});
+        Process process = env.spawn(args, false);
+        if (not wait_for_port(port, std::chrono::seconds(10)))
+            {
+                fmt::println(std::cerr, "ytto's server did not start");
+                ::kill(process.pid, SIGKILL);
+                (void)env.wait(process);
+                return false;
+            }
+
+        struct Case
+        {
+            std::string_view name;
+            std::string body;
+            unsigned expected;
+        };
+        std::vector<Case> const cases{
+            {"not XML", "<feed><entry>", 400},
+            {"no <feed>", "<html><body/></html>", 400},
+            {"entry without a link",
+             "<feed><entry><title>No link</title></entry></feed>", 400},
+        };
+
+        bool ok = true;
+        net::io_context ioc;
+        for (Case const& c : cases)
+            {
+                net::local::stream_protocol::socket socket(ioc);
+                boost::system::error_code ec;
+                socket.connect(
+                    net::local::stream_protocol::endpoint(socket_path.string()),
+                    ec);
+                unsigned status
+                    = ec ? 0 : post(socket, "/process-feed", c.body);
+                if (status != c.expected)
+                    {
+                        fmt::println(std::cerr, "{}: got {}, expected {}",
+                                     c.name, status, c.expected);
+                        ok = false;
+                    }
+            }
+
+        // Feeds are only taken over the socket.
+        {
+            beast::tcp_stream stream(ioc);
+            boost::system::error_code ec;
+            stream.connect({net::ip::make_address("127.0.0.1"), port}, ec);
+            unsigned status = ec ? 0
+                                 : post(stream, "/process-feed",
+                                        bench::synthetic_feed("UCbench", 1));
+            if (status != 403)
+                {
+                    fmt::println(std::cerr,
+                                 "feed over TCP: got {}, expected 403",
+                                 status);
+                    ok = false;
+                }
+        }
+
+        if (not wait_for_port(port, std::chrono::seconds(1)))
+            {
+                fmt::println(std::cerr,
+                             "ytto's server died on a malformed feed");
+                ok = false;
+            }
+
+        ::kill(process.pid, SIGTERM);
+        (void)env.wait(process);
+        fmt::println("malformed feeds: {}", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    /// Records jobs that fit in one batch of a journal, checkpoints it and
+    /// replays the file in another journal. Returns whether the outstanding
+    /// jobs came back as they were recorded.
+    bool check_job_journal(BenchOptions const& options)
+    {
+        std::filesystem::path path = options.work_dir / "journal" / "jobs.jsonl";
+        std::filesystem::remove_all(path.parent_path());
+
+        std::vector<std::string> links;
+        for (size_t i = 0; i < 3; ++i)
+            {
+                links.push_back(fmt::format(
+                    "https://www.youtube.com/watch?v={}",
+                    bench::video_id("UCjournal", i)));
+            }
+
+        JobJournal journal(path);
+        for (std::string const& link : links)
+            {
+                journal.record(Job{.link = link,
+                                   .author = "Bench author",
+                                   .title = "Title",
+                                   .description = "Description",
+                                   .state = JobState::Pending});
+            }
+        journal.record(Job{.link = links[0],
+                           .author = {},
+                           .title = {},
+                           .description = {},
+                           .state = JobState::SubtitlesFetched});
+        journal.record(Job{.link = links[1],
+                           .author = {},
+                           .title = {},
+                           .description = {},
+                           .state = JobState::Summarized});
+        journal.checkpoint();
+
+        std::map<std::string, JobState> expected{
+            {links[0], JobState::SubtitlesFetched},
+            {links[2], JobState::Pending}};
+        std::map<std::string, JobState> replayed;
+        for (Job const& job : JobJournal(path).outstanding())
+            {
+                if (job.title != "Title")
+                    {
+                        fmt::println(std::cerr, "{} lost its title", job.link);
+                        return false;
+                    }
+                replayed[job.link] = job.state;
+            }
+        bool ok = replayed == expected;
+        fmt::println("job journal: {}", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    options.work_dir = std::filesystem::temp_directory_path() / "ytto_bench";
+
+    CLI::App app{
+        "Offline end-to-end benchmark of YoutubeToOllama with a mock LLM "
+        "server and a stub yt-dlp."};
+    app.add_option("--ytto", options.ytto, "Path to YoutubeToOllama")
+        ->capture_default_str();
+    app.add_option("--alloc-library", options.alloc_library,
+                   "LD_PRELOAD library that counts allocations. Empty to "
+                   "disable.")
+        ->capture_default_str();
+    app.add_option("--work-dir", options.work_dir,
+                   "Folder for caches, logs and the stub of yt-dlp")
+        ->capture_default_str();
+    app.add_option("--entries", options.entries,
+                   "Sizes of synthetic feeds")
+        ->capture_default_str();
+    app.add_option("--runs", options.runs, "Runs per size in stdin mode")
+        ->capture_default_str();
+    app.add_option("--clients", options.clients,
+                   "Concurrent clients in server mode")
+        ->capture_default_str();
+    app.add_option("--requests", options.requests,
+                   "Feeds requested per size in server mode")
+        ->capture_default_str();
+    app.add_option("--llm-latency-ms", options.llm_latency_ms,
+                   "Delay of the mock LLM before responding")
+        ->capture_default_str();
+    app.add_option("--llm-stream-chunks", options.llm_stream_chunks,
+                   "Send LLM's response chunked in that many pieces, 0 "
+                   "for a plain response")
+        ->capture_default_str();
+    app.add_option("--llm-chunk-delay-ms", options.llm_chunk_delay_ms,
+                   "Delay between chunks of a streamed response")
+        ->capture_default_str();
+    app.add_option("--llm-response-bytes", options.llm_response_bytes,
+                   "Size of a summary returned by the mock LLM")
+        ->capture_default_str();
+    app.add_option("--subtitle-bytes", options.subtitle_bytes,
+                   "Size of subtitles returned by the stub yt-dlp")
+        ->capture_default_str();
+    app.add_option("--yt-dlp-delay-ms", options.yt_dlp_delay_ms,
+                   "Time the stub yt-dlp pretends to work")
+        ->capture_default_str();
+    app.add_option("-j,--jobs-yt-tlp", options.jobs_yt_dlp,
+                   "Passed to YoutubeToOllama")
+        ->capture_default_str();
+    app.add_option("-J,--jobs-requests", options.jobs_requests,
+                   "Passed to YoutubeToOllama")
+        ->capture_default_str();
+    app.add_flag("--yt-dlp-batch", options.yt_dlp_batch,
+                 "Passed to YoutubeToOllama");
+    app.add_flag("--skip-stdin", options.skip_stdin, "Skip stdin mode");
+    app.add_flag("--skip-server", options.skip_server, "Skip server mode");
+    app.add_flag("--skip-checks", options.skip_checks,
+                 "Skip checks of broken requests");
+    CLI11_PARSE(app, argc, argv);
+
+    // A crashed YoutubeToOllama must not kill the benchmark via SIGPIPE.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::filesystem::remove_all(options.work_dir);
+    std::filesystem::create_directories(options.work_dir);
+    Environment env(options);
+    bench::MockServer mock({
+        .llm_latency = std::chrono::milliseconds(options.llm_latency_ms),
+        .llm_stream_chunks = options.llm_stream_chunks,
+        .llm_chunk_delay = std::chrono::milliseconds(options.llm_chunk_delay_ms),
+        .llm_response_bytes = options.llm_response_bytes,
+    });
+
+    fmt::println("{:<14} {:>7} {:>9} {:>9} {:>9} {:>10} {:>12} {:>10}",
+                 "scenario", "entries", "feeds/s", "p50, s", "p99, s",
+                 "RSS, KiB", "allocations", "alloc, KiB");
+    if (not options.skip_stdin)
+        {
+            bench_stdin(options, env, mock);
+        }
+    if (not options.skip_server)
+        {
+            bench_server(options, env, mock);
+        }
+    fmt::println("LLM requests served by the mock: {}", mock.llm_requests());
+    if (not options.skip_checks
+        and (not check_job_journal(options)
+             or not check_malformed_feeds(options, env, mock)))
+        {
+            return 1;
+        }
+    return 0;
+}
@@ -0,0 +1,312 @@
+// Micro-benchmarks of CPU-bound hot paths on the checked-in corpus.
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/property_tree/ptree.hpp>
+#include <fmt/format.h>
+#include <inja/inja.hpp>
+#include <inja/json.hpp>
+
+#include "ytto/cache_file.hpp"
+#include "ytto/feed.hpp"
+#include "ytto/prompt.hpp"
+#include "ytto/response_parser.hpp"
+
+namespace
+{
+    std::string read_corpus(std::string_view name)
+    {
+        std::ifstream ifs(std::filesystem::path(YTTO_BENCH_CORPUS_DIR) / name);
+        return {std::istreambuf_iterator<char>(ifs),
+                std::istreambuf_iterator<char>()};
+    }
+
+    std::string const& feed()
+    {
+        static std::string const res = read_corpus("youtube_feed.xml");
+        return res;
+    }
+
+    std::string const& subtitles()
+    {
+        static std::string const res = read_corpus("subtitles.txt");
+        return res;
+    }
+
+    std::string const& ollama_response()
+    {
+        static std::string const res = read_corpus("ollama_chat_response.json");
+        return res;
+    }
+
+    inja::json entry_data()
+    {
+        boost::property_tree::ptree tree = parse_feed(feed());
+        for (auto& xml_entry : tree.get_child("feed"))
+            {
+                if ("entry" != xml_entry.first)
+                    {
+                        continue;
+                    }
+                inja::json data;
+                data["author"] = xml_entry.second.get<std::string>("author.name");
+                data["title"] = xml_entry.second.get<std::string>(
+                    "media:group.media:title");
+                data["description"] = xml_entry.second.get<std::string>(
+                    "media:group.media:description");
+                data["link"] = xml_entry.second.get<std::string>(
+                    "link.<xmlattr>.href");
+                data["subtitles"] = subtitles();
+                return data;
+            }
+        return {};
+    }
+
+    void BM_ParseFeed(benchmark::State& state)
+    {
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(parse_feed(feed()));
+            }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations())
+                                * static_cast<int64_t>(feed().size()));
+    }
+    BENCHMARK(BM_ParseFeed);
+
+    void BM_WriteFeed(benchmark::State& state)
+    {
+        boost::property_tree::ptree tree = parse_feed(feed());
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(write_feed(tree));
+            }
+    }
+    BENCHMARK(BM_WriteFeed);
+
+    void BM_RenderPrompt(benchmark::State& state)
+    {
+        inja::json data = entry_data();
+        std::string prompt_template(DEFAULT_PROMPT_TEMPLATE);
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(inja::render(prompt_template, data));
+            }
+    }
+    BENCHMARK(BM_RenderPrompt);
+
+    void BM_EscapePrompt(benchmark::State& state)
+    {
+        std::string prompt = inja::render(DEFAULT_PROMPT_TEMPLATE, entry_data());
+        for (auto _ : state)
+            {
+                std::string copy = prompt;
+                escape_prompt(copy);
+                benchmark::DoNotOptimize(copy);
+            }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations())
+                                * static_cast<int64_t>(prompt.size()));
+    }
+    BENCHMARK(BM_EscapePrompt);
+
+    void BM_RenderRequestBody(benchmark::State& state)
+    {
+        inja::json data = entry_data();
+        std::string prompt_template(DEFAULT_PROMPT_TEMPLATE);
+        std::string http_body_template(DEFAULT_HTTP_BODY_TEMPLATE);
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(render_request_body(
+                    prompt_template, http_body_template, data));
+            }
+    }
+    BENCHMARK(BM_RenderRequestBody);
+
+    void BM_RenderRequestBodyPrecompiled(benchmark::State& state)
+    {
+        inja::json data = entry_data();
+        RequestTemplates templates{std::string(DEFAULT_PROMPT_TEMPLATE),
+                                   std::string(DEFAULT_HTTP_BODY_TEMPLATE)};
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(templates.render(data));
+            }
+    }
+    BENCHMARK(BM_RenderRequestBodyPrecompiled);
+
+    void BM_OllamaChatParserGetResponse(benchmark::State& state)
+    {
+        OllamaChatParser parser;
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(parser.getResponse(ollama_response()));
+            }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations())
+                                * static_cast<int64_t>(ollama_response().size()));
+    }
+    BENCHMARK(BM_OllamaChatParserGetResponse);
+
+    void BM_CacheGetActualKey(benchmark::State& state)
+    {
+        std::string key = "https://www.youtube.com/watch?v=dQw4w9WgXcQ";
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(CacheHexHashFile::get_actual_key(key));
+            }
+    }
+    BENCHMARK(BM_CacheGetActualKey);
+
+    /// Passes allocations through to the heap, counting them.
+    class CountingResource : public std::pmr::memory_resource
+    {
+      public:
+        size_t allocations = 0;
+
+      private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        [[nodiscard]] bool do_is_equal(
+            std::pmr::memory_resource const& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    /// Bookkeeping of a feed like in main_logic: a shared job per entry and
+    /// a key per entry, either straight on the heap or in an arena of 8 KiB
+    /// on the stack. `allocations` counts allocations of the bookkeeping
+    /// that reach the heap per feed.
+    void BM_FeedBookkeeping(benchmark::State& state)
+    {
+        struct Job
+        {
+            std::string link;
+            std::optional<std::string> summary;
+        };
+        bool const use_arena = state.range(0) != 0;
+        boost::property_tree::ptree tree = parse_feed(feed());
+        CountingResource heap;
+        for (auto _ : state)
+            {
+                std::array<std::byte, 8 * 1024> buffer;
+                std::pmr::monotonic_buffer_resource arena(
+                    buffer.data(), buffer.size(), &heap);
+                std::pmr::memory_resource* resource
+                    = use_arena ? static_cast<std::pmr::memory_resource*>(&arena)
+                                : &heap;
+                std::pmr::polymorphic_allocator<Job> allocator(resource);
+                std::pmr::vector<std::shared_ptr<Job>> jobs(resource);
+                // Strings take the allocator of the vector, like keys of
+                // main_logic.
+                std::pmr::vector<std::pmr::string> keys(resource);
+                for (auto& xml_entry : tree.get_child("feed"))
+                    {
+                        if ("entry" != xml_entry.first)
+                            {
+                                continue;
+                            }
+                        auto job = std::allocate_shared<Job>(allocator);
+                        job->link = xml_entry.second.get<std::string>(
+                            "link.<xmlattr>.href");
+                        keys.emplace_back(job->link);
+                        jobs.push_back(std::move(job));
+                    }
+                benchmark::DoNotOptimize(jobs.data());
+                benchmark::DoNotOptimize(keys.data());
+            }
+        state.counters["allocations"] = benchmark::Counter(
+            static_cast<double>(heap.allocations),
+            benchmark::Counter::kAvgIterations);
+    }
+    BENCHMARK(BM_FeedBookkeeping)->ArgName("arena")->Arg(0)->Arg(1);
+
+    /// RequestTemplates::render into an arena per request, like summarize
+    /// within a feed. `allocations` counts chunks the arena takes from the
+    /// heap per request.
+    void BM_RenderRequestBodyArena(benchmark::State& state)
+    {
+        inja::json data = entry_data();
+        RequestTemplates templates{std::string(DEFAULT_PROMPT_TEMPLATE),
+                                   std::string(DEFAULT_HTTP_BODY_TEMPLATE)};
+        CountingResource heap;
+        for (auto _ : state)
+            {
+                std::pmr::monotonic_buffer_resource arena(&heap);
+                benchmark::DoNotOptimize(templates.render(data, &arena));
+            }
+        state.counters["allocations"] = benchmark::Counter(
+            static_cast<double>(heap.allocations),
+            benchmark::Counter::kAvgIterations);
+    }
+    BENCHMARK(BM_RenderRequestBodyArena);
+
+    class CacheFixture : public benchmark::Fixture
+    {
+      public:
+        std::filesystem::path folder;
+
+        void SetUp(benchmark::State const&) override
+        {
+            folder = std::filesystem::temp_directory_path()
+                     / "ytto_micro_bench_cache";
+            std::filesystem::remove_all(folder);
+        }
+
+        void TearDown(benchmark::State const&) override
+        {
+            std::filesystem::remove_all(folder);
+        }
+    };
+
+    BENCHMARK_F(CacheFixture, BM_CacheSet)(benchmark::State& state)
+    {
+        CacheHexHashFile cache(folder);
+        size_t i = 0;
+        for (auto _ : state)
+            {
+                cache.set(
+                    fmt::format("https://www.youtube.com/watch?v={:011}", i++),
+                    subtitles());
+            }
+    }
+
+    BENCHMARK_F(CacheFixture, BM_CacheGetHit)(benchmark::State& state)
+    {
+        CacheHexHashFile cache(folder);
+        std::string key = "https://www.youtube.com/watch?v=dQw4w9WgXcQ";
+        cache.set(key, subtitles());
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(cache.get(key));
+            }
+    }
+
+    BENCHMARK_F(CacheFixture, BM_CacheGetMiss)(benchmark::State& state)
+    {
+        CacheHexHashFile cache(folder);
+        std::string key = "https://www.youtube.com/watch?v=dQw4w9WgXcQ";
+        for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(cache.get(key));
+            }
+    }
+
+}  // namespace
@@ -4,6 +4,10 @@ from conan import ConanFile
 class CompressorRecipe(ConanFile):
     settings = "os", "compiler", "build_type", "arch"
     generators = "CMakeToolchain", "CMakeDeps"
+    options = {"with_benchmarks": [True, False], "with_lmdb": [True, False],
+               "with_nghttp2": [True, False]}
+    default_options = {"with_benchmarks": False, "with_lmdb": True,
+                       "with_nghttp2": True}
     
     def configure(self):
         self.options["boost"].with_stacktrace = True
@@ -22,6 +26,13 @@ class CompressorRecipe(ConanFile):
         self.requires("glaze/[~7]")
         self.requires("openssl/[~3]")
         self.requires("re2/20251105") 
+        if self.options.with_lmdb:
+            self.requires("lmdb/[~0.9]")
+        if self.options.with_nghttp2:
+            # nghttp2_session_mem_send2 and friends
+            self.requires("libnghttp2/[>=1.61 <2]")
+        if self.options.with_benchmarks:
+            self.requires("benchmark/[~1]")
 
     def build_requirements(self):
         self.tool_requires("cmake/3.27.9")
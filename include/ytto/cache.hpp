@@ -2,7 +2,10 @@
 #define INCLUDE_YOUTUBETOOLLAMA_CACHE_HPP_
 
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 class ABCCache
 {
@@ -11,6 +14,21 @@ class ABCCache
     get (std::string const &key) const = 0;
     virtual void set (std::string const &key, std::string const &val) = 0;
 
+    /// `get` of many keys at once, results are in the order of keys.
+    /// Backends override it when they can do it cheaper than one by one.
+    /// Keys are views, so that callers can keep them in an arena.
+    [[nodiscard]] virtual std::vector<std::optional<std::string> >
+    get_many (std::span<std::string_view const> keys) const
+    {
+        std::vector<std::optional<std::string> > res;
+        res.reserve (keys.size ());
+        for (std::string_view key : keys)
+            {
+                res.push_back (get (std::string (key)));
+            }
+        return res;
+    }
+
     virtual ~ABCCache () = default;
 };
 
@@ -1,10 +1,18 @@
 #ifndef INCLUDE_YOUTUBETOOLLAMA_CACHE_FILE_HPP_
 #define INCLUDE_YOUTUBETOOLLAMA_CACHE_FILE_HPP_
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
 #include <filesystem>
 #include <fstream>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <boost/hash2/hash_append.hpp>
 #include <boost/hash2/xxhash.hpp>
@@ -23,6 +31,8 @@
  * 1. Take a path to a folder.
  * 2. Uses files in the folder with filenames as a key.
  * 3. Actual key value is a lowercase hex dump of hash function of a key.
+ * 4. A file is the value and a newline, which reads leave out, so values
+ *    round-trip the same as in CacheLmdb.
  *
  * On collision throws an OmegaException. On any filesystem failure throws
  * exceptions from std::filesystem.
@@ -50,14 +60,73 @@ class CacheHexHashFile final : public ABCCache
     {
         auto hexed_key = get_actual_key (key);
         auto result_path = filepath_to_folder_ / hexed_key;
-        if (std::filesystem::exists (result_path))
+        std::ifstream ifs (result_path);
+        if (not ifs.is_open ())
+            {
+                return std::nullopt;
+            }
+        std::string result;
+        std::getline (ifs, result, '\0');
+        strip_newline (result);
+
+        // Keeps atime fresh for EvictionPolicy::Lru of CacheJanitor on
+        // relatime and noatime mounts as well.
+        std::array<timespec, 2> times{
+            {{.tv_sec = 0, .tv_nsec = UTIME_NOW},
+             {.tv_sec = 0, .tv_nsec = UTIME_OMIT}}};
+        ::utimensat (AT_FDCWD, result_path.c_str (), times.data (), 0);
+        return result;
+    }
+
+    /// Resolves the folder once and opens entries relative to it.
+    [[nodiscard]] std::vector<std::optional<std::string> >
+    get_many (std::span<std::string_view const> keys) const final
+    {
+        int dir_fd = ::open (filepath_to_folder_.c_str (),
+                             O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0)
             {
-                std::ifstream ifs (result_path);
-                std::string result;
-                std::getline (ifs, result, '\0');
-                return result;
+                return ABCCache::get_many (keys);
             }
-        return std::nullopt;
+
+        std::array<timespec, 2> times{{{.tv_sec = 0, .tv_nsec = UTIME_NOW},
+                                       {.tv_sec = 0, .tv_nsec = UTIME_OMIT}}};
+        std::vector<std::optional<std::string> > res;
+        res.reserve (keys.size ());
+        for (std::string_view key : keys)
+            {
+                res.emplace_back ();
+                int fd = ::openat (dir_fd, get_actual_key (key).c_str (),
+                                   O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    {
+                        continue;
+                    }
+                struct stat st{};
+                if (::fstat (fd, &st) == 0)
+                    {
+                        std::string result (static_cast<size_t> (st.st_size),
+                                            '\0');
+                        size_t done = 0;
+                        while (done < result.size ())
+                            {
+                                ssize_t n = ::read (fd, result.data () + done,
+                                                    result.size () - done);
+                                if (n <= 0)
+                                    {
+                                        break;
+                                    }
+                                done += static_cast<size_t> (n);
+                            }
+                        result.resize (done);
+                        strip_newline (result);
+                        ::futimens (fd, times.data ());
+                        res.back () = std::move (result);
+                    }
+                ::close (fd);
+            }
+        ::close (dir_fd);
+        return res;
     }
 
     void
@@ -74,10 +143,20 @@ class CacheHexHashFile final : public ABCCache
         fmt::output_file (result_path.string ()).print ("{}\n", val);
     };
 
-  private:
+    /// Drops the newline `set` writes after a value.
+    static void
+    strip_newline (std::string &value)
+    {
+        if (value.ends_with ('\n'))
+            {
+                value.pop_back ();
+            }
+    }
+
     [[nodiscard]] static std::string
-    get_actual_key (std::string const &key)
+    get_actual_key (std::string_view key)
     {
+        // Hashes the same bytes as of a std::string, so keys don't change.
         boost::hash2::xxhash_64 hash_object;
         boost::hash2::hash_append (hash_object, {}, key);
         std::uint64_t hash = hash_object.result ();
@@ -0,0 +1,214 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_CACHE_JANITOR_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_CACHE_JANITOR_HPP_
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// NOLINTNEXTLINE(performance-enum-size)
+enum class EvictionPolicy : int
+{
+    // Least recently read first. CacheHexHashFile::get updates atime of a
+    // file, so it works on relatime and noatime mounts too.
+    Lru,
+    // Least recently written first, i.e. videos summarized the longest ago.
+    Oldest,
+};
+
+/**
+ * @class CacheJanitor
+ * @brief Keeps a cache folder of CacheHexHashFile under a size budget and
+ * removes entries older than a TTL.
+ * @description Works incrementally: every `step` looks at no more than
+ * `batch` files, so it can be called from the event loop between other work.
+ * A pass first scans the folder, then removes expired entries and, if the
+ * rest is over `max_bytes`, the least recently used (or the oldest ones) until
+ * it fits. Then a new pass starts.
+ *
+ * Only files with hex names are touched, so anything else in the folder (e.g.
+ * the registry of versions of summaries) is kept. Filesystem errors are
+ * ignored: an entry that disappeared meanwhile is just skipped.
+ */
+class CacheJanitor
+{
+  public:
+    struct Options
+    {
+        // 0 means no limit.
+        std::uintmax_t max_bytes = 0;
+        // 0 means entries never expire.
+        std::chrono::seconds ttl{0};
+        EvictionPolicy policy = EvictionPolicy::Lru;
+        std::size_t batch = 256;
+    };
+
+    struct Step
+    {
+        std::uintmax_t evicted_bytes = 0;
+        std::uintmax_t evicted_files = 0;
+        // Set when a scan of the folder finished during the step.
+        std::optional<std::uintmax_t> stored_bytes;
+    };
+
+  private:
+    struct Entry
+    {
+        std::filesystem::path path;
+        std::uintmax_t size;
+        std::chrono::system_clock::time_point time;
+    };
+
+    std::filesystem::path folder_;
+    Options options_;
+    std::filesystem::directory_iterator it_;
+    bool scanning_ = false;
+    std::vector<Entry> scanned_;
+    std::uintmax_t scanned_bytes_ = 0;
+    std::vector<Entry> to_evict_;
+    std::size_t evicted_ = 0;
+
+  public:
+    CacheJanitor (std::filesystem::path folder, Options options)
+        : folder_ (std::move (folder)), options_ (options)
+    {
+    }
+
+    [[nodiscard]] bool
+    enabled () const
+    {
+        return options_.max_bytes != 0 || options_.ttl.count () != 0;
+    }
+
+    /// Whether the last pass is over and the next step starts a new one.
+    [[nodiscard]] bool
+    pass_done () const
+    {
+        return not scanning_ && evicted_ >= to_evict_.size ();
+    }
+
+    Step
+    step ()
+    {
+        Step res;
+        if (evicted_ < to_evict_.size ())
+            {
+                evict_batch (res);
+                return res;
+            }
+        if (not scanning_)
+            {
+                start_scan ();
+            }
+        scan_batch (res);
+        return res;
+    }
+
+  private:
+    void
+    start_scan ()
+    {
+        std::error_code ec;
+        it_ = std::filesystem::directory_iterator (folder_, ec);
+        scanning_ = true;
+        scanned_.clear ();
+        scanned_bytes_ = 0;
+    }
+
+    void
+    scan_batch (Step &res)
+    {
+        std::error_code ec;
+        for (std::size_t i = 0;
+             i < options_.batch && it_ != std::filesystem::directory_iterator ();
+             ++i, it_.increment (ec))
+            {
+                if (ec)
+                    {
+                        break;
+                    }
+                std::string name = it_->path ().filename ().string ();
+                if (name.empty ()
+                    || not std::ranges::all_of (
+                        name, [] (char c) { return std::isxdigit (c) != 0; }))
+                    {
+                        continue;
+                    }
+                struct stat st{};
+                if (::stat (it_->path ().c_str (), &st) != 0
+                    || not S_ISREG (st.st_mode))
+                    {
+                        continue;
+                    }
+                timespec const &ts = options_.policy == EvictionPolicy::Lru
+                                         ? st.st_atim
+                                         : st.st_mtim;
+                auto time = std::chrono::system_clock::time_point (
+                    std::chrono::duration_cast<
+                        std::chrono::system_clock::duration> (
+                        std::chrono::seconds (ts.tv_sec)
+                        + std::chrono::nanoseconds (ts.tv_nsec)));
+                auto size = static_cast<std::uintmax_t> (st.st_size);
+                scanned_.push_back ({it_->path (), size, time});
+                scanned_bytes_ += size;
+            }
+
+        if (ec || it_ == std::filesystem::directory_iterator ())
+            {
+                finish_scan (res);
+            }
+    }
+
+    void
+    finish_scan (Step &res)
+    {
+        scanning_ = false;
+        std::ranges::sort (scanned_, {}, &Entry::time);
+
+        to_evict_.clear ();
+        evicted_ = 0;
+        std::uintmax_t kept_bytes = scanned_bytes_;
+        auto const expired_before
+            = std::chrono::system_clock::now () - options_.ttl;
+        for (Entry &entry : scanned_)
+            {
+                bool const expired = options_.ttl.count () != 0
+                                     && entry.time < expired_before;
+                bool const over_budget = options_.max_bytes != 0
+                                         && kept_bytes > options_.max_bytes;
+                if (not expired && not over_budget)
+                    {
+                        break;
+                    }
+                kept_bytes -= entry.size;
+                to_evict_.push_back (std::move (entry));
+            }
+        scanned_.clear ();
+        res.stored_bytes = kept_bytes;
+    }
+
+    void
+    evict_batch (Step &res)
+    {
+        for (std::size_t i = 0;
+             i < options_.batch && evicted_ < to_evict_.size (); ++i)
+            {
+                Entry const &entry = to_evict_[evicted_++];
+                std::error_code ec;
+                if (std::filesystem::remove (entry.path, ec))
+                    {
+                        res.evicted_bytes += entry.size;
+                        ++res.evicted_files;
+                    }
+            }
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_CACHE_JANITOR_HPP_
@@ -0,0 +1,184 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_CACHE_LMDB_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_CACHE_LMDB_HPP_
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <lmdb.h>
+
+#include "cache.hpp"
+#include "omega_exception.hpp"
+
+/**
+ * @class CacheLmdb
+ * @brief A cache in an LMDB environment: one memory-mapped B-tree instead of a
+ * file per key.
+ * @description Takes a path to a folder and creates `data.mdb` and
+ * `lock.mdb` in it. `map_size` is the maximum size of the database; it is
+ * only reserved as address space, not allocated.
+ *
+ * Reads are done in read-only transactions, which don't block each other
+ * nor writers, and copy the value straight out of the mapped page. Every
+ * `set` is a transaction of its own.
+ *
+ * Like CacheHexHashFile, a rewrite of an existing key throws an
+ * OmegaException. Any failure of LMDB throws an OmegaException with the
+ * error of LMDB as data.
+ */
+class CacheLmdb final : public ABCCache
+{
+    MDB_env *env_ = nullptr;
+    MDB_dbi dbi_{};
+
+    static void
+    check (int rc, char const *what)
+    {
+        if (rc != MDB_SUCCESS)
+            {
+                throw OmegaException<std::string> (what, mdb_strerror (rc));
+            }
+    }
+
+    /// Aborts a transaction unless it was committed.
+    class Txn
+    {
+        MDB_txn *txn_ = nullptr;
+
+      public:
+        Txn (MDB_env *env, unsigned int flags)
+        {
+            check (mdb_txn_begin (env, nullptr, flags, &txn_),
+                   "Failed to begin an LMDB transaction");
+        }
+
+        Txn (Txn const &) = delete;
+        Txn &operator= (Txn const &) = delete;
+
+        ~Txn ()
+        {
+            if (txn_ != nullptr)
+                {
+                    mdb_txn_abort (txn_);
+                }
+        }
+
+        [[nodiscard]] MDB_txn *
+        get () const
+        {
+            return txn_;
+        }
+
+        void
+        commit ()
+        {
+            MDB_txn *txn = txn_;
+            txn_ = nullptr;
+            check (mdb_txn_commit (txn),
+                   "Failed to commit an LMDB transaction");
+        }
+    };
+
+    static MDB_val
+    to_val (std::string_view str)
+    {
+        // LMDB does not write through mv_data of a key or of a value given to
+        // mdb_put without MDB_RESERVE.
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        return {.mv_size = str.size (),
+                .mv_data = const_cast<char *> (str.data ())};
+    }
+
+  public:
+    CacheLmdb (std::filesystem::path const &folder, std::size_t map_size)
+    {
+        std::filesystem::create_directories (folder);
+        check (mdb_env_create (&env_), "Failed to create an LMDB environment");
+        try
+            {
+                check (mdb_env_set_mapsize (env_, map_size),
+                       "Failed to set map size of an LMDB environment");
+                // MDB_NOTLS: reader slots belong to transactions, not to
+                // threads, so one thread may have several reads open.
+                check (mdb_env_open (env_, folder.c_str (), MDB_NOTLS, 0664),
+                       "Failed to open an LMDB environment");
+                Txn txn (env_, 0);
+                check (mdb_dbi_open (txn.get (), nullptr, 0, &dbi_),
+                       "Failed to open an LMDB database");
+                txn.commit ();
+            }
+        catch (...)
+            {
+                mdb_env_close (env_);
+                throw;
+            }
+    }
+
+    CacheLmdb (CacheLmdb const &) = delete;
+    CacheLmdb &operator= (CacheLmdb const &) = delete;
+
+    ~CacheLmdb () override { mdb_env_close (env_); }
+
+    [[nodiscard]] std::optional<std::string>
+    get (std::string const &key) const final
+    {
+        Txn txn (env_, MDB_RDONLY);
+        MDB_val mdb_key = to_val (key);
+        MDB_val mdb_val{};
+        int rc = mdb_get (txn.get (), dbi_, &mdb_key, &mdb_val);
+        if (rc == MDB_NOTFOUND)
+            {
+                return std::nullopt;
+            }
+        check (rc, "Failed to read from LMDB");
+        return std::string (static_cast<char const *> (mdb_val.mv_data),
+                            mdb_val.mv_size);
+    }
+
+    /// All keys are read in one transaction.
+    [[nodiscard]] std::vector<std::optional<std::string> >
+    get_many (std::span<std::string_view const> keys) const final
+    {
+        Txn txn (env_, MDB_RDONLY);
+        std::vector<std::optional<std::string> > res;
+        res.reserve (keys.size ());
+        for (std::string_view key : keys)
+            {
+                MDB_val mdb_key = to_val (key);
+                MDB_val mdb_val{};
+                int rc = mdb_get (txn.get (), dbi_, &mdb_key, &mdb_val);
+                if (rc == MDB_NOTFOUND)
+                    {
+                        res.emplace_back ();
+                        continue;
+                    }
+                check (rc, "Failed to read from LMDB");
+                res.emplace_back (std::in_place,
+                                  static_cast<char const *> (mdb_val.mv_data),
+                                  mdb_val.mv_size);
+            }
+        return res;
+    }
+
+    void
+    set (std::string const &key, std::string const &val) final
+    {
+        Txn txn (env_, 0);
+        MDB_val mdb_key = to_val (key);
+        MDB_val mdb_val = to_val (val);
+        int rc = mdb_put (txn.get (), dbi_, &mdb_key, &mdb_val,
+                          MDB_NOOVERWRITE);
+        if (rc == MDB_KEYEXIST)
+            {
+                throw OmegaException<std::string> ("Intentional rewrite", key);
+            }
+        check (rc, "Failed to write to LMDB");
+        txn.commit ();
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_CACHE_LMDB_HPP_
@@ -0,0 +1,149 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_FAILURE_CACHE_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_FAILURE_CACHE_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <fmt/os.h>
+#include <glaze/glaze.hpp>
+#include <magic_enum/magic_enum.hpp>
+
+#include "cache_file.hpp"
+#include "metrics.hpp"
+
+/**
+ * @class FailureCache
+ * @brief Videos whose summarization failed, with when to try them again.
+ * @description Members-only videos, premieres or age-restricted ones fail the
+ * same way on every poll. After the Nth failure in a row a video is not
+ * tried again for `base * 2^(N-1)`, but no longer than `max`; a success
+ * forgets its failures.
+ *
+ * An entry is a file with a JSON object in a folder, named like in
+ * CacheHexHashFile by a hash of the link, so entries survive restarts and are
+ * shared by every process using the folder. Filesystem errors are ignored: at
+ * worst a video is tried too early.
+ */
+class FailureCache
+{
+  public:
+    struct Options
+    {
+        std::chrono::seconds base{600};
+        std::chrono::seconds max{86400};
+    };
+
+    struct Failure
+    {
+        // Name of a FailureKind.
+        std::string kind;
+        std::uint32_t attempts = 0;
+        // Seconds since the epoch.
+        std::int64_t retry_at = 0;
+        std::string error;
+    };
+
+    // Errors of yt-dlp may be pages long; the start is enough for a log.
+    static constexpr std::size_t ERROR_LIMIT = 512;
+
+  private:
+    std::filesystem::path folder_;
+    Options options_;
+
+    [[nodiscard]] std::filesystem::path
+    path_of (std::string const &link) const
+    {
+        return folder_ / CacheHexHashFile::get_actual_key (link);
+    }
+
+    [[nodiscard]] std::optional<Failure>
+    read (std::string const &link) const
+    {
+        std::ifstream ifs (path_of (link));
+        if (not ifs.is_open ())
+            {
+                return std::nullopt;
+            }
+        std::string raw;
+        std::getline (ifs, raw, '\0');
+        Failure failure;
+        if (glz::read_json (failure, raw))
+            {
+                return std::nullopt;
+            }
+        return failure;
+    }
+
+    static std::int64_t
+    now ()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds> (
+                   std::chrono::system_clock::now ().time_since_epoch ())
+            .count ();
+    }
+
+  public:
+    FailureCache (std::filesystem::path folder, Options options)
+        : folder_ (std::move (folder)), options_ (options)
+    {
+        std::filesystem::create_directories (folder_);
+    }
+
+    /// The last failure of a video, if it is too early to try it again.
+    [[nodiscard]] std::optional<Failure>
+    backed_off (std::string const &link) const
+    {
+        std::optional<Failure> failure = read (link);
+        if (not failure.has_value () || failure->retry_at <= now ())
+            {
+                return std::nullopt;
+            }
+        return failure;
+    }
+
+    /// Returns the recorded failure.
+    Failure
+    record (std::string const &link, FailureKind kind, std::string_view error)
+    {
+        Failure failure = read (link).value_or (Failure{});
+        failure.kind = magic_enum::enum_name (kind);
+        ++failure.attempts;
+        // Shifting by more than that overflows; max is hit long before.
+        std::uint32_t const doublings = std::min (failure.attempts - 1, 30U);
+        std::chrono::seconds const delay = std::min (
+            options_.base * (std::int64_t{1} << doublings), options_.max);
+        failure.retry_at = now () + delay.count ();
+        failure.error = error.substr (0, ERROR_LIMIT);
+
+        std::string buffer;
+        if (not glz::write_json (failure, buffer))
+            {
+                try
+                    {
+                        fmt::output_file (path_of (link).string ())
+                            .print ("{}\n", buffer);
+                    }
+                catch (std::system_error const &)
+                    {
+                    }
+            }
+        return failure;
+    }
+
+    void
+    forget (std::string const &link)
+    {
+        std::error_code ec;
+        std::filesystem::remove (path_of (link), ec);
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_FAILURE_CACHE_HPP_
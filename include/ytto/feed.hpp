@@ -0,0 +1,34 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_FEED_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_FEED_HPP_
+
+#include <spanstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+/**
+ * Parses YouTube's RSS (Atom) feed. Throws
+ * boost::property_tree::xml_parser_error on malformed XML.
+ */
+[[nodiscard]] inline boost::property_tree::ptree
+parse_feed (std::string_view rss_feed)
+{
+    boost::property_tree::ptree tree;
+    // Reads the feed in place instead of copying it into a stringstream.
+    std::ispanstream istr (rss_feed);
+    boost::property_tree::read_xml (istr, tree);
+    return tree;
+}
+
+[[nodiscard]] inline std::string
+write_feed (boost::property_tree::ptree const &tree)
+{
+    std::ostringstream strs;
+    boost::property_tree::write_xml (strs, tree);
+    return std::move (strs).str ();
+}
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_FEED_HPP_
@@ -0,0 +1,628 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_HTTP2_CLIENT_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_HTTP2_CLIENT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/url.hpp>
+#include <corral/Event.h>
+#include <corral/Nursery.h>
+#include <corral/asio.h>
+#include <corral/corral.h>
+#include <corral/wait.h>
+#include <nghttp2/nghttp2.h>
+
+/**
+ * @class Http2Connection
+ * @brief One TLS connection to a host, over which requests are multiplexed as
+ * HTTP/2 streams.
+ * @description `run` connects, offers "h2" via ALPN and then reads and writes
+ * frames until the connection breaks. Requests wait for `ready` first; if the
+ * server did not pick "h2", `speaks_http2` is false and the connection is
+ * closed.
+ *
+ * Frames are parsed and made by nghttp2, which neither reads nor writes the
+ * socket itself. Requests only submit streams into the session and wake the
+ * writer, so a cancelled request can't leave half of a frame on the wire.
+ */
+class Http2Connection
+{
+    struct Stream
+    {
+        std::string request_body;
+        std::size_t sent = 0;
+        unsigned status = 0;
+        std::string body;
+        std::string error;
+        bool closed = false;
+        corral::Event done;
+    };
+
+    static constexpr std::size_t READ_BUFFER_SIZE = 16 * 1024;
+    // The server decides, but nghttp2 queues streams above its limit anyway.
+    static constexpr std::uint32_t MAX_CONCURRENT_STREAMS = 100;
+    static constexpr std::uint32_t INITIAL_WINDOW_SIZE = 1024 * 1024;
+
+    boost::asio::ssl::stream<boost::beast::tcp_stream> stream_;
+    std::string host_;
+    std::string port_;
+    std::chrono::steady_clock::duration connect_timeout_;
+    nghttp2_session *session_ = nullptr;
+    std::map<std::int32_t, std::shared_ptr<Stream> > streams_;
+    std::vector<std::shared_ptr<Stream> > closed_;
+    std::optional<corral::Event> wake_;
+    corral::Event ready_;
+    bool http2_ = false;
+    bool http2_refused_ = false;
+    bool dead_ = false;
+    std::string error_;
+
+  public:
+    Http2Connection (boost::asio::io_context &ioc,
+                     boost::asio::ssl::context &ssl_ctx, std::string host,
+                     std::string port,
+                     std::chrono::steady_clock::duration connect_timeout)
+        : stream_ (ioc, ssl_ctx), host_ (std::move (host)),
+          port_ (std::move (port)), connect_timeout_ (connect_timeout)
+    {
+        stream_.set_verify_callback (
+            boost::asio::ssl::host_name_verification (host_));
+    }
+
+    Http2Connection (Http2Connection const &) = delete;
+    Http2Connection &operator= (Http2Connection const &) = delete;
+
+    ~Http2Connection ()
+    {
+        if (session_ != nullptr)
+            {
+                nghttp2_session_del (session_);
+            }
+    }
+
+    /// Connects and then serves the connection until it breaks.
+    static corral::Task<void>
+    run (std::shared_ptr<Http2Connection> self)
+    {
+        co_await self->establish ();
+        self->ready_.trigger ();
+        if (self->http2_)
+            {
+                co_await corral::anyOf (self->read_loop (),
+                                        self->write_loop ());
+            }
+        self->fail_all ();
+    }
+
+    [[nodiscard]] corral::Event &
+    ready ()
+    {
+        return ready_;
+    }
+
+    /// Valid after `ready`.
+    [[nodiscard]] bool
+    speaks_http2 () const
+    {
+        return http2_;
+    }
+
+    /// Whether the server picked another protocol than "h2" via ALPN.
+    [[nodiscard]] bool
+    http2_refused () const
+    {
+        return http2_refused_;
+    }
+
+    [[nodiscard]] bool
+    dead () const
+    {
+        return dead_;
+    }
+
+    [[nodiscard]] std::string const &
+    error () const
+    {
+        return error_;
+    }
+
+    /// Sends a request as a new stream and waits for the whole response.
+    corral::Task<std::expected<std::string, std::string> >
+    request (boost::beast::http::verb method, boost::url const &url,
+             boost::beast::http::fields const &headers,
+             std::string_view request_body)
+    {
+        if (dead_ || not http2_)
+            {
+                co_return std::unexpected (error_);
+            }
+
+        std::string const method_str (boost::beast::http::to_string (method));
+        std::string const authority (url.encoded_host_and_port ());
+        std::string path (url.encoded_resource ());
+        if (path.empty ())
+            {
+                path = "/";
+            }
+
+        // Names of fields are lowercase in HTTP/2, and fields of HTTP/1.1
+        // connections are forbidden. nghttp2 copies names and values.
+        std::vector<std::pair<std::string, std::string> > fields;
+        for (auto const &field : headers)
+            {
+                std::string name (field.name_string ());
+                std::ranges::transform (
+                    name, name.begin (), [] (unsigned char c)
+                        { return static_cast<char> (std::tolower (c)); });
+                if (name == "host" || name == "connection"
+                    || name == "keep-alive" || name == "proxy-connection"
+                    || name == "transfer-encoding" || name == "upgrade")
+                    {
+                        continue;
+                    }
+                fields.emplace_back (std::move (name),
+                                     std::string (field.value ()));
+            }
+        fields.emplace_back ("user-agent", BOOST_BEAST_VERSION_STRING);
+
+        std::vector<nghttp2_nv> nva;
+        nva.reserve (fields.size () + 4);
+        nva.push_back (make_nv (":method", method_str));
+        nva.push_back (make_nv (":scheme", "https"));
+        nva.push_back (make_nv (":authority", authority));
+        nva.push_back (make_nv (":path", path));
+        for (auto const &[name, value] : fields)
+            {
+                nva.push_back (make_nv (name, value));
+            }
+
+        auto stream = std::make_shared<Stream> ();
+        stream->request_body = request_body;
+        nghttp2_data_provider2 provider{};
+        provider.source.ptr = stream.get ();
+        provider.read_callback = &read_request_body;
+
+        std::int32_t const stream_id = nghttp2_submit_request2 (
+            session_, nullptr, nva.data (), nva.size (),
+            request_body.empty () ? nullptr : &provider, stream.get ());
+        if (stream_id < 0)
+            {
+                co_return std::unexpected (nghttp2_strerror (stream_id));
+            }
+        streams_.emplace (stream_id, stream);
+        wake ();
+
+        // If the request is cancelled, e.g. by a timeout, the server is told
+        // to stop generating.
+        struct ResetUnlessClosed
+        {
+            Http2Connection &conn;
+            Stream const &stream;
+            std::int32_t stream_id;
+
+            ~ResetUnlessClosed ()
+            {
+                if (not stream.closed && not conn.dead_)
+                    {
+                        nghttp2_submit_rst_stream (conn.session_,
+                                                   NGHTTP2_FLAG_NONE,
+                                                   stream_id, NGHTTP2_CANCEL);
+                        conn.wake ();
+                    }
+            }
+        } reset_guard{*this, *stream, stream_id};
+
+        co_await stream->done;
+
+        if (not stream->error.empty ())
+            {
+                co_return std::unexpected (stream->error);
+            }
+        if (stream->status != 200)
+            {
+                co_return std::unexpected ("returned with status not 200");
+            }
+        co_return std::move (stream->body);
+    }
+
+  private:
+    static nghttp2_nv
+    make_nv (std::string_view name, std::string_view value)
+    {
+        // nghttp2 does not write through names and values.
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-const-cast)
+        return {
+            .name = reinterpret_cast<std::uint8_t *> (
+                const_cast<char *> (name.data ())),
+            .value = reinterpret_cast<std::uint8_t *> (
+                const_cast<char *> (value.data ())),
+            .namelen = name.size (),
+            .valuelen = value.size (),
+            .flags = NGHTTP2_NV_FLAG_NONE,
+        };
+        // NOLINTEND(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    corral::Task<void>
+    establish ()
+    {
+        namespace net = boost::asio;
+
+        auto resolver = net::ip::tcp::resolver{stream_.get_executor ()};
+        auto [ec_resolve, results] = co_await resolver.async_resolve (
+            host_, port_, corral::asio_nothrow_awaitable);
+        if (ec_resolve)
+            {
+                error_ = ec_resolve.message ();
+                co_return;
+            }
+
+        if (not SSL_set_tlsext_host_name (stream_.native_handle (),
+                                          host_.c_str ()))
+            {
+                error_ = "Failed to set SNI";
+                co_return;
+            }
+
+        stream_.next_layer ().expires_after (connect_timeout_);
+        auto [ec_connect, ep] = co_await stream_.next_layer ().async_connect (
+            results, corral::asio_nothrow_awaitable);
+        if (ec_connect)
+            {
+                error_ = ec_connect.message ();
+                co_return;
+            }
+
+        auto ec_handshake = co_await stream_.async_handshake (
+            net::ssl::stream_base::client, corral::asio_nothrow_awaitable);
+        if (ec_handshake)
+            {
+                error_ = ec_handshake.message ();
+                co_return;
+            }
+        // Idle connections are kept; requests have timeouts of their own.
+        stream_.next_layer ().expires_never ();
+
+        unsigned char const *alpn = nullptr;
+        unsigned int alpn_len = 0;
+        SSL_get0_alpn_selected (stream_.native_handle (), &alpn, &alpn_len);
+        if (std::string_view (reinterpret_cast<char const *> (alpn), alpn_len)
+            != "h2")
+            {
+                error_ = "The server did not negotiate HTTP/2";
+                http2_refused_ = true;
+                co_return;
+            }
+
+        nghttp2_session_callbacks *callbacks = nullptr;
+        nghttp2_session_callbacks_new (&callbacks);
+        nghttp2_session_callbacks_set_on_header_callback (callbacks,
+                                                          &on_header);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback (
+            callbacks, &on_data_chunk_recv);
+        nghttp2_session_callbacks_set_on_stream_close_callback (
+            callbacks, &on_stream_close);
+        int const rv = nghttp2_session_client_new (&session_, callbacks, this);
+        nghttp2_session_callbacks_del (callbacks);
+        if (rv != 0)
+            {
+                error_ = nghttp2_strerror (rv);
+                co_return;
+            }
+
+        std::array<nghttp2_settings_entry, 3> const settings{{
+            {NGHTTP2_SETTINGS_ENABLE_PUSH, 0},
+            {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, MAX_CONCURRENT_STREAMS},
+            {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, INITIAL_WINDOW_SIZE},
+        }};
+        nghttp2_submit_settings (session_, NGHTTP2_FLAG_NONE, settings.data (),
+                                 settings.size ());
+        http2_ = true;
+    }
+
+    corral::Task<void>
+    read_loop ()
+    {
+        std::array<std::uint8_t, READ_BUFFER_SIZE> buffer{};
+        while (nghttp2_session_want_read (session_) != 0
+               || nghttp2_session_want_write (session_) != 0)
+            {
+                auto [ec, bytes_read] = co_await stream_.async_read_some (
+                    boost::asio::buffer (buffer),
+                    corral::asio_nothrow_awaitable);
+                if (ec)
+                    {
+                        error_ = ec.message ();
+                        co_return;
+                    }
+                nghttp2_ssize const rv = nghttp2_session_mem_recv2 (
+                    session_, buffer.data (), bytes_read);
+                if (rv < 0)
+                    {
+                        error_ = nghttp2_strerror (static_cast<int> (rv));
+                        co_return;
+                    }
+                // Waiters are resumed only now, out of callbacks of nghttp2.
+                for (std::shared_ptr<Stream> &stream : closed_)
+                    {
+                        stream->done.trigger ();
+                    }
+                closed_.clear ();
+                // Acknowledgements of settings, window updates and so on.
+                wake ();
+            }
+        error_ = "The connection was closed by the server";
+    }
+
+    corral::Task<void>
+    write_loop ()
+    {
+        while (true)
+            {
+                // Anything submitted from now on wakes this very event, even
+                // while the frames before are being written.
+                wake_.emplace ();
+                while (true)
+                    {
+                        std::string out;
+                        std::uint8_t const *data = nullptr;
+                        nghttp2_ssize len = 0;
+                        while ((len = nghttp2_session_mem_send2 (session_,
+                                                                 &data))
+                               > 0)
+                            {
+                                out.append (reinterpret_cast<char const *> (
+                                                data),
+                                            static_cast<std::size_t> (len));
+                            }
+                        if (len < 0)
+                            {
+                                error_ = nghttp2_strerror (
+                                    static_cast<int> (len));
+                                co_return;
+                            }
+                        if (out.empty ())
+                            {
+                                break;
+                            }
+                        auto [ec, bytes_written]
+                            = co_await boost::asio::async_write (
+                                stream_, boost::asio::buffer (out),
+                                corral::asio_nothrow_awaitable);
+                        if (ec)
+                            {
+                                error_ = ec.message ();
+                                co_return;
+                            }
+                    }
+                co_await *wake_;
+            }
+    }
+
+    void
+    wake ()
+    {
+        if (wake_.has_value ())
+            {
+                wake_->trigger ();
+            }
+    }
+
+    void
+    fail_all ()
+    {
+        dead_ = true;
+        for (auto &[stream_id, stream] : streams_)
+            {
+                stream->closed = true;
+                stream->error = error_;
+                closed_.push_back (stream);
+            }
+        streams_.clear ();
+        for (std::shared_ptr<Stream> &stream : closed_)
+            {
+                stream->done.trigger ();
+            }
+        closed_.clear ();
+    }
+
+    static Stream *
+    stream_of (nghttp2_session *session, std::int32_t stream_id)
+    {
+        return static_cast<Stream *> (
+            nghttp2_session_get_stream_user_data (session, stream_id));
+    }
+
+    static int
+    on_header (nghttp2_session *session, nghttp2_frame const *frame,
+               std::uint8_t const *name, std::size_t namelen,
+               std::uint8_t const *value, std::size_t valuelen,
+               std::uint8_t /*flags*/, void * /*user_data*/)
+    {
+        if (frame->hd.type != NGHTTP2_HEADERS)
+            {
+                return 0;
+            }
+        Stream *stream = stream_of (session, frame->hd.stream_id);
+        if (stream == nullptr
+            || std::string_view (reinterpret_cast<char const *> (name),
+                                 namelen)
+                   != ":status")
+            {
+                return 0;
+            }
+        auto const *status = reinterpret_cast<char const *> (value);
+        std::from_chars (status, status + valuelen, stream->status);
+        return 0;
+    }
+
+    static int
+    on_data_chunk_recv (nghttp2_session *session, std::uint8_t /*flags*/,
+                        std::int32_t stream_id, std::uint8_t const *data,
+                        std::size_t len, void * /*user_data*/)
+    {
+        Stream *stream = stream_of (session, stream_id);
+        if (stream != nullptr)
+            {
+                stream->body.append (reinterpret_cast<char const *> (data),
+                                     len);
+            }
+        return 0;
+    }
+
+    static int
+    on_stream_close (nghttp2_session * /*session*/, std::int32_t stream_id,
+                     std::uint32_t error_code, void *user_data)
+    {
+        auto *self = static_cast<Http2Connection *> (user_data);
+        auto it = self->streams_.find (stream_id);
+        if (it == self->streams_.end ())
+            {
+                return 0;
+            }
+        it->second->closed = true;
+        if (error_code != NGHTTP2_NO_ERROR)
+            {
+                it->second->error = nghttp2_http2_strerror (error_code);
+            }
+        self->closed_.push_back (std::move (it->second));
+        self->streams_.erase (it);
+        return 0;
+    }
+
+    static nghttp2_ssize
+    read_request_body (nghttp2_session * /*session*/,
+                       std::int32_t /*stream_id*/, std::uint8_t *buf,
+                       std::size_t length, std::uint32_t *data_flags,
+                       nghttp2_data_source *source, void * /*user_data*/)
+    {
+        auto *stream = static_cast<Stream *> (source->ptr);
+        std::size_t const n
+            = std::min (length, stream->request_body.size () - stream->sent);
+        std::memcpy (buf, stream->request_body.data () + stream->sent, n);
+        stream->sent += n;
+        if (stream->sent == stream->request_body.size ())
+            {
+                *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+            }
+        return static_cast<nghttp2_ssize> (n);
+    }
+};
+
+/**
+ * @class Http2Pool
+ * @brief A connection of HTTP/2 per host, shared by all requests to it.
+ * @description Connections are served in the nursery of `run`, which must be
+ * running for the pool to be used. A broken connection is replaced on the
+ * next request. Hosts that didn't negotiate HTTP/2 are remembered, and
+ * `request` returns std::nullopt for them right away, so that the caller
+ * sends the request over HTTP/1.1 instead.
+ */
+class Http2Pool
+{
+    boost::asio::io_context &ioc_;
+    boost::asio::ssl::context ssl_ctx_;
+    std::chrono::steady_clock::duration connect_timeout_;
+    std::chrono::steady_clock::duration request_timeout_;
+    corral::Nursery *nursery_ = nullptr;
+    std::map<std::string, std::shared_ptr<Http2Connection> > connections_;
+    std::set<std::string> http1_hosts_;
+
+  public:
+    Http2Pool (boost::asio::io_context &ioc,
+               std::chrono::steady_clock::duration connect_timeout,
+               std::chrono::steady_clock::duration request_timeout)
+        : ioc_ (ioc), ssl_ctx_ (boost::asio::ssl::context::tlsv13),
+          connect_timeout_ (connect_timeout), request_timeout_ (request_timeout)
+    {
+        ssl_ctx_.set_verify_mode (boost::asio::ssl::verify_peer);
+        ssl_ctx_.set_default_verify_paths ();
+        // Length-prefixed protocol names, the preferred one first.
+        static constexpr std::array<unsigned char, 12> alpn{
+            2, 'h', '2', 8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+        SSL_CTX_set_alpn_protos (ssl_ctx_.native_handle (), alpn.data (),
+                                 static_cast<unsigned int> (alpn.size ()));
+    }
+
+    corral::Task<void>
+    run ()
+    {
+        CORRAL_WITH_NURSERY (nursery)
+        {
+            nursery_ = &nursery;
+            co_await corral::SuspendForever{};
+            co_return corral::join;
+        };
+    }
+
+    /// std::nullopt if the host does not speak HTTP/2.
+    corral::Task<std::optional<std::expected<std::string, std::string> > >
+    request (boost::beast::http::verb method, boost::url const &url,
+             boost::beast::http::fields const &headers,
+             std::string_view request_body)
+    {
+        std::string const host = url.host_name ();
+        std::string port (url.port ());
+        if (port.empty ())
+            {
+                port = "443";
+            }
+        std::string const authority = host + ":" + port;
+        if (nursery_ == nullptr || http1_hosts_.contains (authority))
+            {
+                co_return std::nullopt;
+            }
+
+        std::shared_ptr<Http2Connection> &slot = connections_[authority];
+        if (slot == nullptr || slot->dead ())
+            {
+                slot = std::make_shared<Http2Connection> (
+                    ioc_, ssl_ctx_, host, port, connect_timeout_);
+                nursery_->start (&Http2Connection::run, slot);
+            }
+        // The slot may be replaced while this request waits.
+        std::shared_ptr<Http2Connection> conn = slot;
+
+        co_await conn->ready ();
+        if (conn->http2_refused ())
+            {
+                http1_hosts_.insert (authority);
+                co_return std::nullopt;
+            }
+        if (not conn->speaks_http2 ())
+            {
+                co_return std::unexpected (conn->error ());
+            }
+
+        auto [res, timed_out] = co_await corral::anyOf (
+            conn->request (method, url, headers, request_body),
+            corral::sleepFor (ioc_, request_timeout_));
+        if (not res.has_value ())
+            {
+                co_return std::unexpected ("HTTP/2 request timed out");
+            }
+        co_return std::move (*res);
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_HTTP2_CLIENT_HPP_
@@ -0,0 +1,293 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_JOB_JOURNAL_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_JOB_JOURNAL_HPP_
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <glaze/glaze.hpp>
+#include <magic_enum/magic_enum.hpp>
+
+#include "omega_exception.hpp"
+
+// NOLINTNEXTLINE(performance-enum-size)
+enum class JobState : int
+{
+    Pending,
+    SubtitlesFetched,
+    Summarized,
+    Failed,
+};
+
+struct Job
+{
+    std::string link;
+    std::string author;
+    std::string title;
+    std::string description;
+    JobState state = JobState::Pending;
+};
+
+/**
+ * @class JobJournal
+ * @brief Durable on-disk queue of summarization jobs.
+ * @description An append-only file with a JSON object per line. A line is
+ * written on every change of a job's state: Pending (with everything needed to
+ * redo the job), SubtitlesFetched, Summarized or Failed. Lines are buffered in
+ * memory and appended in batches with a single write; `checkpoint` also makes
+ * them durable via fsync.
+ *
+ * On construction the file is replayed: jobs whose last state is Pending or
+ * SubtitlesFetched are outstanding and returned by `outstanding`. Then the
+ * file is compacted to outstanding jobs only. It is compacted again when it
+ * grows over `compact_after_bytes`.
+ *
+ * Throws OmegaException with the path if the file can not be opened.
+ */
+class JobJournal
+{
+    struct Line
+    {
+        std::string state;
+        std::string link;
+        std::optional<std::string> author;
+        std::optional<std::string> title;
+        std::optional<std::string> description;
+    };
+
+    std::filesystem::path path_;
+    std::FILE *file_ = nullptr;
+    std::string buffer_;
+    std::size_t batch_bytes_;
+    std::size_t compact_after_bytes_;
+    std::size_t written_bytes_ = 0;
+    std::map<std::string, Job> outstanding_;
+
+  public:
+    static constexpr std::size_t BATCH_BYTES_DEFAULT = 64 * 1024;
+    static constexpr std::size_t COMPACT_AFTER_BYTES_DEFAULT
+        = 16 * 1024 * 1024;
+
+    explicit JobJournal (std::filesystem::path path,
+                         std::size_t batch_bytes = BATCH_BYTES_DEFAULT,
+                         std::size_t compact_after_bytes
+                         = COMPACT_AFTER_BYTES_DEFAULT)
+        : path_ (std::move (path)), batch_bytes_ (batch_bytes),
+          compact_after_bytes_ (compact_after_bytes)
+    {
+        if (path_.has_parent_path ())
+            {
+                std::filesystem::create_directories (path_.parent_path ());
+            }
+        replay ();
+        compact ();
+    }
+
+    JobJournal (JobJournal const &) = delete;
+    JobJournal &operator= (JobJournal const &) = delete;
+
+    ~JobJournal ()
+    {
+        checkpoint ();
+        if (file_ != nullptr)
+            {
+                std::fclose (file_);
+            }
+    }
+
+    /// Jobs that were not finished when the journal was written last time,
+    /// or that are in progress now.
+    [[nodiscard]] std::vector<Job>
+    outstanding () const
+    {
+        std::vector<Job> res;
+        res.reserve (outstanding_.size ());
+        for (auto const &[link, job] : outstanding_)
+            {
+                res.push_back (job);
+            }
+        return res;
+    }
+
+    void
+    record (Job const &job)
+    {
+        Line line{.state = std::string (magic_enum::enum_name (job.state)),
+                  .link = job.link,
+                  .author = std::nullopt,
+                  .title = std::nullopt,
+                  .description = std::nullopt};
+        if (job.state == JobState::Pending)
+            {
+                line.author = job.author;
+                line.title = job.title;
+                line.description = job.description;
+                outstanding_[job.link] = job;
+            }
+        else if (job.state == JobState::SubtitlesFetched)
+            {
+                auto it = outstanding_.find (job.link);
+                if (it != outstanding_.end ())
+                    {
+                        it->second.state = job.state;
+                    }
+            }
+        else
+            {
+                outstanding_.erase (job.link);
+            }
+
+        // write_json overwrites its output, so lines buffered so far must
+        // not be it.
+        std::string serialized;
+        if (glz::write_json (line, serialized))
+            {
+                return;
+            }
+        buffer_ += serialized;
+        buffer_.push_back ('\n');
+        if (buffer_.size () >= batch_bytes_)
+            {
+                flush ();
+            }
+    }
+
+    /// Appends buffered lines with one write. Not durable against power
+    /// loss, see `checkpoint`.
+    void
+    flush ()
+    {
+        if (buffer_.empty () || file_ == nullptr)
+            {
+                return;
+            }
+        std::fwrite (buffer_.data (), 1, buffer_.size (), file_);
+        std::fflush (file_);
+        written_bytes_ += buffer_.size ();
+        buffer_.clear ();
+        if (written_bytes_ >= compact_after_bytes_)
+            {
+                compact ();
+            }
+    }
+
+    void
+    checkpoint ()
+    {
+        flush ();
+        if (file_ != nullptr)
+            {
+                ::fsync (::fileno (file_));
+            }
+    }
+
+  private:
+    void
+    replay ()
+    {
+        std::ifstream ifs (path_);
+        std::string raw_line;
+        Line line;
+        while (std::getline (ifs, raw_line))
+            {
+                // A torn last line after a crash is just skipped.
+                if (glz::read_json (line, raw_line))
+                    {
+                        continue;
+                    }
+                std::optional<JobState> state
+                    = magic_enum::enum_cast<JobState> (line.state);
+                if (not state.has_value ())
+                    {
+                        continue;
+                    }
+                if (*state == JobState::Pending)
+                    {
+                        outstanding_[line.link]
+                            = Job{.link = line.link,
+                                  .author = line.author.value_or (""),
+                                  .title = line.title.value_or (""),
+                                  .description = line.description.value_or (""),
+                                  .state = *state};
+                    }
+                else if (*state == JobState::SubtitlesFetched)
+                    {
+                        auto it = outstanding_.find (line.link);
+                        if (it != outstanding_.end ())
+                            {
+                                it->second.state = *state;
+                            }
+                    }
+                else
+                    {
+                        outstanding_.erase (line.link);
+                    }
+            }
+    }
+
+    /// Rewrites the file with outstanding jobs only, atomically via rename.
+    void
+    compact ()
+    {
+        std::string content;
+        for (auto const &[link, job] : outstanding_)
+            {
+                Line line{.state = std::string (
+                              magic_enum::enum_name (JobState::Pending)),
+                          .link = job.link,
+                          .author = job.author,
+                          .title = job.title,
+                          .description = job.description};
+                std::string serialized;
+                if (glz::write_json (line, serialized))
+                    {
+                        continue;
+                    }
+                content += serialized;
+                content.push_back ('\n');
+                if (job.state == JobState::SubtitlesFetched)
+                    {
+                        content += fmt::format (
+                            R"({{"state":"{}","link":{}}})",
+                            magic_enum::enum_name (job.state),
+                            glz::write_json (job.link).value_or ("\"\""));
+                        content.push_back ('\n');
+                    }
+            }
+
+        std::filesystem::path tmp = path_;
+        tmp += ".tmp";
+        std::FILE *tmp_file = std::fopen (tmp.c_str (), "w");
+        if (tmp_file == nullptr)
+            {
+                throw OmegaException<std::filesystem::path> (
+                    "Failed to write the job journal", tmp);
+            }
+        std::fwrite (content.data (), 1, content.size (), tmp_file);
+        std::fflush (tmp_file);
+        ::fsync (::fileno (tmp_file));
+        std::fclose (tmp_file);
+
+        if (file_ != nullptr)
+            {
+                std::fclose (file_);
+            }
+        std::filesystem::rename (tmp, path_);
+        file_ = std::fopen (path_.c_str (), "a");
+        if (file_ == nullptr)
+            {
+                throw OmegaException<std::filesystem::path> (
+                    "Failed to open the job journal", path_);
+            }
+        written_bytes_ = content.size ();
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_JOB_JOURNAL_HPP_
@@ -0,0 +1,231 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_LLM_USAGE_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_LLM_USAGE_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "ytto/metrics.hpp"
+
+/**
+ * What an LLM reported about a request: token counts and, for Ollama, where
+ * the time went. Durations are zero if not reported.
+ */
+struct LlmUsage
+{
+    std::string model;
+    std::uint64_t prompt_tokens = 0;
+    std::uint64_t generated_tokens = 0;
+    // Prefill: evaluation of the prompt.
+    std::chrono::nanoseconds prompt_duration{0};
+    // Decode: generation of the response.
+    std::chrono::nanoseconds generation_duration{0};
+    // Loading of the model into memory before the request could start.
+    std::chrono::nanoseconds load_duration{0};
+};
+
+/**
+ * @class LlmUsageMetrics
+ * @brief LlmUsage summed up per backend (host and port of --url) and model.
+ * @description Throughput is rendered as counters of tokens and of seconds,
+ * so that rate() of one divided by rate() of the other gives tokens per
+ * second over any window, and as a gauge of tokens per second since start.
+ *
+ * A series is created under a lock on the first request of a model; updates
+ * of an existing series are relaxed atomic operations like the rest of
+ * Metrics.
+ */
+class LlmUsageMetrics
+{
+  public:
+    // Ollama reports a few milliseconds of load_duration even for a model
+    // already in memory.
+    static constexpr std::chrono::milliseconds LOAD_STALL{500};
+
+    static constexpr std::array<double, 10> PROMPT_TOKENS_BOUNDS{
+        256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, 131072};
+
+    struct Series
+    {
+        Counter requests;
+        Counter prompt_tokens;
+        Counter generated_tokens;
+        Counter prompt_ns;
+        Counter generation_ns;
+        Counter load_ns;
+        Counter load_stalls;
+        Histogram prompt_size{std::vector<double> (
+            PROMPT_TOKENS_BOUNDS.begin (), PROMPT_TOKENS_BOUNDS.end ())};
+
+        [[nodiscard]] double
+        prefill_tokens_per_second () const
+        {
+            return per_second (prompt_tokens, prompt_ns);
+        }
+
+        [[nodiscard]] double
+        decode_tokens_per_second () const
+        {
+            return per_second (generated_tokens, generation_ns);
+        }
+
+      private:
+        static double
+        per_second (Counter const &tokens, Counter const &ns)
+        {
+            std::uint64_t const duration = ns.value ();
+            return duration == 0 ? 0.
+                                 : static_cast<double> (tokens.value ()) * 1e9
+                                       / static_cast<double> (duration);
+        }
+    };
+
+  private:
+    mutable std::mutex mutex_;
+    // (backend, model)
+    std::map<std::pair<std::string, std::string>, Series> series_;
+
+  public:
+    void
+    observe (std::string const &backend, LlmUsage const &usage)
+    {
+        Series &series = series_of (backend, usage.model);
+        series.requests.inc ();
+        series.prompt_tokens.inc (usage.prompt_tokens);
+        series.generated_tokens.inc (usage.generated_tokens);
+        series.prompt_ns.inc (
+            static_cast<std::uint64_t> (usage.prompt_duration.count ()));
+        series.generation_ns.inc (
+            static_cast<std::uint64_t> (usage.generation_duration.count ()));
+        series.load_ns.inc (
+            static_cast<std::uint64_t> (usage.load_duration.count ()));
+        if (usage.load_duration >= LOAD_STALL)
+            {
+                series.load_stalls.inc ();
+            }
+        series.prompt_size.observe (static_cast<double> (usage.prompt_tokens));
+    }
+
+    /// Calls `fn(backend, model, series)` for every series.
+    void
+    for_each (std::function<void (std::string const &, std::string const &,
+                                  Series const &)> const &fn) const
+    {
+        std::lock_guard lock (mutex_);
+        for (auto const &[key, series] : series_)
+            {
+                fn (key.first, key.second, series);
+            }
+    }
+
+    void
+    render (std::string &out) const
+    {
+        std::lock_guard lock (mutex_);
+        if (series_.empty ())
+            {
+                return;
+            }
+        render_counter (out, "ytto_llm_requests_total",
+                        "Requests to an LLM with a parsed response.",
+                        &Series::requests);
+        render_counter (out, "ytto_llm_prompt_tokens_total",
+                        "Tokens of prompts evaluated by an LLM.",
+                        &Series::prompt_tokens);
+        render_counter (out, "ytto_llm_generated_tokens_total",
+                        "Tokens generated by an LLM.",
+                        &Series::generated_tokens);
+        render_seconds (out, "ytto_llm_prefill_seconds_total",
+                        "Time an LLM spent evaluating prompts.",
+                        &Series::prompt_ns);
+        render_seconds (out, "ytto_llm_decode_seconds_total",
+                        "Time an LLM spent generating.", &Series::generation_ns);
+        render_seconds (out, "ytto_llm_load_seconds_total",
+                        "Time an LLM spent loading the model.",
+                        &Series::load_ns);
+        render_counter (out, "ytto_llm_load_stalls_total",
+                        "Requests that waited for the model to load.",
+                        &Series::load_stalls);
+
+        out += "# HELP ytto_llm_prefill_tokens_per_second Prompt tokens per "
+               "second of prefill since start.\n"
+               "# TYPE ytto_llm_prefill_tokens_per_second gauge\n";
+        for (auto const &[key, series] : series_)
+            {
+                fmt::format_to (std::back_inserter (out),
+                                "ytto_llm_prefill_tokens_per_second{{{}}} {}\n",
+                                labels (key), series.prefill_tokens_per_second ());
+            }
+        out += "# HELP ytto_llm_decode_tokens_per_second Generated tokens per "
+               "second of decode since start.\n"
+               "# TYPE ytto_llm_decode_tokens_per_second gauge\n";
+        for (auto const &[key, series] : series_)
+            {
+                fmt::format_to (std::back_inserter (out),
+                                "ytto_llm_decode_tokens_per_second{{{}}} {}\n",
+                                labels (key), series.decode_tokens_per_second ());
+            }
+
+        out += "# HELP ytto_llm_prompt_tokens Sizes of prompts in tokens.\n"
+               "# TYPE ytto_llm_prompt_tokens histogram\n";
+        for (auto const &[key, series] : series_)
+            {
+                series.prompt_size.render_series (out, "ytto_llm_prompt_tokens",
+                                                  labels (key));
+            }
+    }
+
+  private:
+    Series &
+    series_of (std::string const &backend, std::string const &model)
+    {
+        std::lock_guard lock (mutex_);
+        return series_[{backend, model}];
+    }
+
+    static std::string
+    labels (std::pair<std::string, std::string> const &key)
+    {
+        return fmt::format ("backend=\"{}\",model=\"{}\"", key.first,
+                            key.second);
+    }
+
+    void
+    render_counter (std::string &out, std::string_view name,
+                    std::string_view help, Counter Series::*counter) const
+    {
+        fmt::format_to (std::back_inserter (out),
+                        "# HELP {0} {1}\n# TYPE {0} counter\n", name, help);
+        for (auto const &[key, series] : series_)
+            {
+                fmt::format_to (std::back_inserter (out), "{}{{{}}} {}\n", name,
+                                labels (key), (series.*counter).value ());
+            }
+    }
+
+    void
+    render_seconds (std::string &out, std::string_view name,
+                    std::string_view help, Counter Series::*ns) const
+    {
+        fmt::format_to (std::back_inserter (out),
+                        "# HELP {0} {1}\n# TYPE {0} counter\n", name, help);
+        for (auto const &[key, series] : series_)
+            {
+                fmt::format_to (
+                    std::back_inserter (out), "{}{{{}}} {}\n", name,
+                    labels (key),
+                    static_cast<double> ((series.*ns).value ()) / 1e9);
+            }
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_LLM_USAGE_HPP_
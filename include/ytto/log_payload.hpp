@@ -0,0 +1,62 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_LOG_PAYLOAD_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_LOG_PAYLOAD_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @class PayloadLog
+ * @brief Policy for logging of large payloads: subtitles, prompts, requests
+ * and responses.
+ * @description Only a preview of at most `limit` bytes of a payload is logged,
+ * so that the frontend copies into the queue of the logging backend a few
+ * kilobytes instead of megabytes. With `sample_every` N only every Nth
+ * payload is logged at all.
+ *
+ * Checking whether to log anything is left to the caller (see LOG_PAYLOAD in
+ * main.cpp), since a payload must not even be serialized unless the level is
+ * enabled.
+ */
+class PayloadLog
+{
+    std::size_t limit_ = LIMIT_DEFAULT;
+    std::size_t sample_every_ = 1;
+    std::atomic<std::size_t> seen_{0};
+
+  public:
+    static constexpr std::size_t LIMIT_DEFAULT = 4096;
+
+    /// `limit` 0 means whole payloads.
+    void
+    configure (std::size_t limit, std::size_t sample_every) noexcept
+    {
+        limit_ = limit;
+        sample_every_ = sample_every;
+    }
+
+    /// Whether the current payload is in the sample.
+    [[nodiscard]] bool
+    sample () noexcept
+    {
+        return sample_every_ <= 1
+               || seen_.fetch_add (1, std::memory_order_relaxed)
+                          % sample_every_
+                      == 0;
+    }
+
+    [[nodiscard]] std::string_view
+    head (std::string_view payload) const noexcept
+    {
+        return limit_ == 0 ? payload : payload.substr (0, limit_);
+    }
+
+    /// Bytes of the payload not in `head`.
+    [[nodiscard]] std::size_t
+    cut (std::string_view payload) const noexcept
+    {
+        return payload.size () - head (payload).size ();
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_LOG_PAYLOAD_HPP_
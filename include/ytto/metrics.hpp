@@ -0,0 +1,435 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_METRICS_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <magic_enum/magic_enum.hpp>
+
+/**
+ * Lock-free primitives for metrics in Prometheus's text exposition format.
+ * Every update is a single relaxed atomic operation, so it is fine to call
+ * them on a hot path. Rendering reads the atomics without any
+ * synchronization, therefore a scrape may see a histogram's count and its
+ * buckets from slightly different moments. Prometheus does not care.
+ */
+
+class Counter
+{
+    std::atomic<std::uint64_t> value_{0};
+
+  public:
+    void
+    inc (std::uint64_t n = 1) noexcept
+    {
+        value_.fetch_add (n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t
+    value () const noexcept
+    {
+        return value_.load (std::memory_order_relaxed);
+    }
+};
+
+class Gauge
+{
+    std::atomic<std::int64_t> value_{0};
+
+  public:
+    void
+    inc (std::int64_t n = 1) noexcept
+    {
+        value_.fetch_add (n, std::memory_order_relaxed);
+    }
+
+    void
+    dec (std::int64_t n = 1) noexcept
+    {
+        value_.fetch_sub (n, std::memory_order_relaxed);
+    }
+
+    void
+    set (std::int64_t n) noexcept
+    {
+        value_.store (n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::int64_t
+    value () const noexcept
+    {
+        return value_.load (std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @class GaugeGuard
+ * @brief Increments a gauge for lifetime of the object. Survives cancellation
+ * of a coroutine, unlike a pair of inc()/dec() calls around a co_await.
+ */
+class GaugeGuard
+{
+    Gauge *gauge_;
+
+  public:
+    explicit GaugeGuard (Gauge &gauge) noexcept : gauge_ (&gauge)
+    {
+        gauge_->inc ();
+    }
+
+    GaugeGuard (GaugeGuard const &) = delete;
+    GaugeGuard &operator= (GaugeGuard const &) = delete;
+
+    ~GaugeGuard () { gauge_->dec (); }
+};
+
+/**
+ * @class Histogram
+ * @brief Cumulative histogram with fixed upper bounds of buckets.
+ */
+class Histogram
+{
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+    std::atomic<double> sum_{0.};
+
+  public:
+    // Seconds. From a cache hit up to MAX_PROMPT_TIME.
+    static constexpr std::array<double, 16> LATENCY_BOUNDS{
+        0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.,
+        2.5,   5.,   10.,   30.,  60., 120., 300., 600.};
+
+    explicit Histogram (std::vector<double> bounds)
+        : bounds_ (std::move (bounds)),
+          buckets_ (new std::atomic<std::uint64_t>[bounds_.size () + 1] {})
+    {
+    }
+
+    Histogram ()
+        : Histogram (std::vector<double> (LATENCY_BOUNDS.begin (),
+                                          LATENCY_BOUNDS.end ()))
+    {
+    }
+
+    void
+    observe (double value) noexcept
+    {
+        std::size_t idx = 0;
+        while (idx < bounds_.size () && value > bounds_[idx])
+            {
+                ++idx;
+            }
+        buckets_[idx].fetch_add (1, std::memory_order_relaxed);
+        sum_.fetch_add (value, std::memory_order_relaxed);
+    }
+
+    template <typename Rep, typename Period>
+    void
+    observe (std::chrono::duration<Rep, Period> duration) noexcept
+    {
+        observe (std::chrono::duration<double> (duration).count ());
+    }
+
+    void
+    render (std::string &out, std::string_view name,
+            std::string_view help) const
+    {
+        fmt::format_to (std::back_inserter (out),
+                        "# HELP {0} {1}\n# TYPE {0} histogram\n", name, help);
+        render_series (out, name, "");
+    }
+
+    /// Buckets, sum and count without HELP and TYPE, for histograms with
+    /// labels. `labels` is e.g. `model="x"`.
+    void
+    render_series (std::string &out, std::string_view name,
+                   std::string_view labels) const
+    {
+        std::string_view const sep = labels.empty () ? "" : ",";
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < bounds_.size (); ++i)
+            {
+                cumulative += buckets_[i].load (std::memory_order_relaxed);
+                fmt::format_to (std::back_inserter (out),
+                                "{}_bucket{{{}{}le=\"{}\"}} {}\n", name,
+                                labels, sep, bounds_[i], cumulative);
+            }
+        cumulative
+            += buckets_[bounds_.size ()].load (std::memory_order_relaxed);
+        std::string const braced
+            = labels.empty () ? "" : fmt::format ("{{{}}}", labels);
+        fmt::format_to (std::back_inserter (out),
+                        "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n{0}_sum{4} {5}\n"
+                        "{0}_count{4} {3}\n",
+                        name, labels, sep, cumulative, braced,
+                        sum_.load (std::memory_order_relaxed));
+    }
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Observes time between construction and destruction in a histogram.
+ */
+class ScopedTimer
+{
+    Histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+
+  public:
+    explicit ScopedTimer (Histogram &histogram) noexcept
+        : histogram_ (histogram), start_ (std::chrono::steady_clock::now ())
+    {
+    }
+
+    ScopedTimer (ScopedTimer const &) = delete;
+    ScopedTimer &operator= (ScopedTimer const &) = delete;
+
+    ~ScopedTimer ()
+    {
+        histogram_.observe (std::chrono::steady_clock::now () - start_);
+    }
+};
+
+// NOLINTNEXTLINE(performance-enum-size)
+enum class FailureKind : int
+{
+    YtDlp,
+    // No subtitles in any of --language.
+    NoSubtitles,
+    LlmRequest,
+    LlmResponseParse,
+    FeedFetch,
+    BadRequest,
+    // A client too slow to send a request or to read a response.
+    ClientTimeout,
+};
+
+struct CacheMetrics
+{
+    Counter hits;
+    Counter misses;
+    Gauge stored_bytes;
+    Counter evicted_bytes;
+    Counter evicted_files;
+};
+
+struct SemaphoreMetrics
+{
+    Gauge waiting;
+    Gauge in_flight;
+};
+
+/// The queue between fetching of subtitles and the LLM, see Pipeline in
+/// main.cpp.
+struct PipelineMetrics
+{
+    // Entries waiting for room in the queue, i.e. held back from yt-dlp.
+    Gauge backpressured;
+    // Entries in the queue: with subtitles being fetched or fetched.
+    Gauge queued;
+    // How long fetched subtitles waited for the LLM.
+    Histogram ready_wait;
+};
+
+/// Admission of feeds by a server, see --max-concurrent-feeds,
+/// --max-queued-jobs and --max-connections.
+struct AdmissionMetrics
+{
+    Gauge connections;
+    // Feeds being processed.
+    Gauge feeds;
+    // Entries of feeds being summarized, including the ones finishing in
+    // background after --feed-deadline.
+    Gauge jobs;
+    // Feeds refused with 503 Service Unavailable.
+    Counter rejected;
+    // Feeds served with cached summaries only.
+    Counter cached_only;
+};
+
+/**
+ * @class Metrics
+ * @brief All metrics of the application in one place.
+ */
+class Metrics
+{
+  public:
+    Histogram yt_dlp_duration;
+    Histogram llm_latency;
+    Histogram feed_fetch_duration;
+    Histogram request_duration;
+
+    CacheMetrics cache_summaries;
+    CacheMetrics cache_subtitles;
+
+    SemaphoreMetrics semaphore_yt_dlp;
+    SemaphoreMetrics semaphore_llm;
+
+    PipelineMetrics pipeline;
+
+    AdmissionMetrics admission;
+
+    std::array<Counter, magic_enum::enum_count<FailureKind> ()> failures;
+    // Entries not tried since they failed recently, see FailureCache.
+    Counter retries_backed_off;
+
+    void
+    fail (FailureKind kind) noexcept
+    {
+        failures[magic_enum::enum_index (kind).value ()].inc ();
+    }
+
+    [[nodiscard]] std::string
+    render () const
+    {
+        std::string out;
+        yt_dlp_duration.render (out, "ytto_yt_dlp_duration_seconds",
+                                "Duration of yt-dlp invocations.");
+        llm_latency.render (out, "ytto_llm_latency_seconds",
+                            "Duration of requests to an LLM.");
+        feed_fetch_duration.render (out, "ytto_feed_fetch_duration_seconds",
+                                    "Duration of fetching of an RSS feed.");
+        request_duration.render (out, "ytto_request_duration_seconds",
+                                 "End-to-end duration of server's requests.");
+
+        out += "# HELP ytto_cache_requests_total Lookups in caches.\n"
+               "# TYPE ytto_cache_requests_total counter\n";
+        render_cache_requests (out, "summaries", cache_summaries);
+        render_cache_requests (out, "subtitles", cache_subtitles);
+
+        out += "# HELP ytto_cache_hit_ratio Hits divided by all lookups.\n"
+               "# TYPE ytto_cache_hit_ratio gauge\n";
+        render_cache_ratio (out, "summaries", cache_summaries);
+        render_cache_ratio (out, "subtitles", cache_subtitles);
+
+        out += "# HELP ytto_cache_stored_bytes Size of a cache folder as of "
+               "the last scan. Only scanned with a size limit or a TTL.\n"
+               "# TYPE ytto_cache_stored_bytes gauge\n";
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_cache_stored_bytes{{cache=\"summaries\"}} {}\n"
+                        "ytto_cache_stored_bytes{{cache=\"subtitles\"}} {}\n",
+                        cache_summaries.stored_bytes.value (),
+                        cache_subtitles.stored_bytes.value ());
+        out += "# HELP ytto_cache_evicted_bytes_total Bytes of evicted or "
+               "expired entries.\n"
+               "# TYPE ytto_cache_evicted_bytes_total counter\n";
+        fmt::format_to (
+            std::back_inserter (out),
+            "ytto_cache_evicted_bytes_total{{cache=\"summaries\"}} {}\n"
+            "ytto_cache_evicted_bytes_total{{cache=\"subtitles\"}} {}\n",
+            cache_summaries.evicted_bytes.value (),
+            cache_subtitles.evicted_bytes.value ());
+        out += "# HELP ytto_cache_evicted_entries_total Evicted or expired "
+               "entries.\n"
+               "# TYPE ytto_cache_evicted_entries_total counter\n";
+        fmt::format_to (
+            std::back_inserter (out),
+            "ytto_cache_evicted_entries_total{{cache=\"summaries\"}} {}\n"
+            "ytto_cache_evicted_entries_total{{cache=\"subtitles\"}} {}\n",
+            cache_summaries.evicted_files.value (),
+            cache_subtitles.evicted_files.value ());
+
+        out += "# HELP ytto_semaphore_waiting Tasks waiting for a slot.\n"
+               "# TYPE ytto_semaphore_waiting gauge\n";
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_semaphore_waiting{{semaphore=\"yt_dlp\"}} {}\n"
+                        "ytto_semaphore_waiting{{semaphore=\"llm\"}} {}\n",
+                        semaphore_yt_dlp.waiting.value (),
+                        semaphore_llm.waiting.value ());
+        out += "# HELP ytto_semaphore_in_flight Tasks holding a slot.\n"
+               "# TYPE ytto_semaphore_in_flight gauge\n";
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_semaphore_in_flight{{semaphore=\"yt_dlp\"}} {}\n"
+                        "ytto_semaphore_in_flight{{semaphore=\"llm\"}} {}\n",
+                        semaphore_yt_dlp.in_flight.value (),
+                        semaphore_llm.in_flight.value ());
+
+        out += "# HELP ytto_pipeline_backpressured Entries waiting for room "
+               "in the queue to the LLM before fetching subtitles.\n"
+               "# TYPE ytto_pipeline_backpressured gauge\n";
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_pipeline_backpressured {}\n",
+                        pipeline.backpressured.value ());
+        out += "# HELP ytto_pipeline_queued Entries in the queue to the LLM, "
+               "fetching subtitles or with subtitles fetched.\n"
+               "# TYPE ytto_pipeline_queued gauge\n";
+        fmt::format_to (std::back_inserter (out), "ytto_pipeline_queued {}\n",
+                        pipeline.queued.value ());
+        pipeline.ready_wait.render (
+            out, "ytto_pipeline_ready_wait_seconds",
+            "Time fetched subtitles waited for the LLM.");
+
+        out += "# HELP ytto_connections_open Connections to the server.\n"
+               "# TYPE ytto_connections_open gauge\n";
+        fmt::format_to (std::back_inserter (out), "ytto_connections_open {}\n",
+                        admission.connections.value ());
+        out += "# HELP ytto_feeds_in_flight Feeds being processed.\n"
+               "# TYPE ytto_feeds_in_flight gauge\n";
+        fmt::format_to (std::back_inserter (out), "ytto_feeds_in_flight {}\n",
+                        admission.feeds.value ());
+        out += "# HELP ytto_jobs_pending Entries of feeds being summarized.\n"
+               "# TYPE ytto_jobs_pending gauge\n";
+        fmt::format_to (std::back_inserter (out), "ytto_jobs_pending {}\n",
+                        admission.jobs.value ());
+        out += "# HELP ytto_feeds_shed_total Feeds not processed fully since "
+               "the server was overloaded.\n"
+               "# TYPE ytto_feeds_shed_total counter\n";
+        fmt::format_to (
+            std::back_inserter (out),
+            "ytto_feeds_shed_total{{response=\"unavailable\"}} {}\n"
+            "ytto_feeds_shed_total{{response=\"cached_only\"}} {}\n",
+            admission.rejected.value (), admission.cached_only.value ());
+
+        out += "# HELP ytto_failures_total Failures by kind.\n"
+               "# TYPE ytto_failures_total counter\n";
+        for (auto [kind, name] : magic_enum::enum_entries<FailureKind> ())
+            {
+                fmt::format_to (
+                    std::back_inserter (out),
+                    "ytto_failures_total{{kind=\"{}\"}} {}\n", name,
+                    failures[magic_enum::enum_index (kind).value ()].value ());
+            }
+        out += "# HELP ytto_retries_backed_off_total Entries not tried since "
+               "they failed recently.\n"
+               "# TYPE ytto_retries_backed_off_total counter\n";
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_retries_backed_off_total {}\n",
+                        retries_backed_off.value ());
+        return out;
+    }
+
+  private:
+    static void
+    render_cache_requests (std::string &out, std::string_view cache,
+                           CacheMetrics const &metrics)
+    {
+        fmt::format_to (
+            std::back_inserter (out),
+            "ytto_cache_requests_total{{cache=\"{0}\",result=\"hit\"}} {1}\n"
+            "ytto_cache_requests_total{{cache=\"{0}\",result=\"miss\"}} {2}\n",
+            cache, metrics.hits.value (), metrics.misses.value ());
+    }
+
+    static void
+    render_cache_ratio (std::string &out, std::string_view cache,
+                        CacheMetrics const &metrics)
+    {
+        std::uint64_t hits = metrics.hits.value ();
+        std::uint64_t all = hits + metrics.misses.value ();
+        fmt::format_to (std::back_inserter (out),
+                        "ytto_cache_hit_ratio{{cache=\"{}\"}} {}\n", cache,
+                        all == 0 ? 0.
+                                 : static_cast<double> (hits)
+                                       / static_cast<double> (all));
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_METRICS_HPP_
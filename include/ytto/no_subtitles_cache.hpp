@@ -0,0 +1,81 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_NO_SUBTITLES_CACHE_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_NO_SUBTITLES_CACHE_HPP_
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <fmt/os.h>
+
+#include "cache_file.hpp"
+
+/**
+ * @class NoSubtitlesCache
+ * @brief Remembers for a TTL videos that had no subtitles in any of the
+ * preferred languages, so that they aren't asked from yt-dlp on every poll.
+ * @description An entry is a file in a folder, named like in
+ * CacheHexHashFile by a hash of the link and the languages, since other
+ * languages may have subtitles. Its modification time is when the video was
+ * found without subtitles. Being files, entries survive restarts and are
+ * shared by every process using the folder, which matters for the stdin mode
+ * that a feed reader starts on every poll.
+ *
+ * An expired entry is removed on lookup. Filesystem errors are ignored: at
+ * worst a video is asked from yt-dlp again.
+ */
+class NoSubtitlesCache
+{
+    std::filesystem::path folder_;
+    std::chrono::seconds ttl_;
+
+    [[nodiscard]] std::filesystem::path
+    path_of (std::string const &link, std::string const &languages) const
+    {
+        return folder_
+               / CacheHexHashFile::get_actual_key (
+                   fmt::format ("{}#{}", link, languages));
+    }
+
+  public:
+    NoSubtitlesCache (std::filesystem::path folder, std::chrono::seconds ttl)
+        : folder_ (std::move (folder)), ttl_ (ttl)
+    {
+        std::filesystem::create_directories (folder_);
+    }
+
+    [[nodiscard]] bool
+    contains (std::string const &link, std::string const &languages) const
+    {
+        std::filesystem::path const path = path_of (link, languages);
+        std::error_code ec;
+        auto const written = std::filesystem::last_write_time (path, ec);
+        if (ec)
+            {
+                return false;
+            }
+        if (std::filesystem::file_time_type::clock::now () - written > ttl_)
+            {
+                std::filesystem::remove (path, ec);
+                return false;
+            }
+        return true;
+    }
+
+    void
+    add (std::string const &link, std::string const &languages)
+    {
+        try
+            {
+                // Rewriting an entry restarts its TTL.
+                fmt::output_file (path_of (link, languages).string ())
+                    .print ("{}\n", link);
+            }
+        catch (std::system_error const &)
+            {
+            }
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_NO_SUBTITLES_CACHE_HPP_
@@ -0,0 +1,163 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_PROMPT_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_PROMPT_HPP_
+
+#include <algorithm>
+#include <ios>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <inja/environment.hpp>
+#include <inja/inja.hpp>
+#include <inja/json.hpp>
+
+constexpr std::string_view DEFAULT_HTTP_BODY_TEMPLATE = R"({
+    "model": "gemma3:4b-it-qat",
+    "stream": false,
+    "messages": [
+      {
+        "role": "user",
+        "content": "{{ prompt }}"
+      }
+    ]
+})";
+
+constexpr std::string_view DEFAULT_PROMPT_TEMPLATE
+    = R"(Always be brutally honest (to the point of being a little bit rude), smart, and extremely laconic. 
+Do not rewrite instructions provided by user.
+You will be supplied with author's name, title, description and subtitles of a YouTube video. 
+Please, provide a summary with main points.
+
+Author's name:
+
+```
+{{ author }}
+```
+
+Title:
+```
+{{ title }}
+```
+
+```
+{{ description }}
+```
+
+Subtitles:
+
+```
+{{ subtitles }}
+```
+)";
+
+/**
+ * Escapes a rendered prompt, so that it can be put inside of a JSON string in
+ * an HTTP body template.
+ */
+template <typename String>
+void
+escape_prompt (String &prompt)
+{
+    auto const specials = static_cast<std::size_t> (std::ranges::count_if (
+        prompt, [] (char c) { return c == '\n' || c == '"'; }));
+    if (specials == 0)
+        {
+            return;
+        }
+    // One pass with one allocation; replace_all would go through the string
+    // twice, buffering replaced parts.
+    String escaped (prompt.get_allocator ());
+    escaped.reserve (prompt.size () + specials);
+    for (char c : prompt)
+        {
+            if (c == '\n')
+                {
+                    escaped += R"(\n)";
+                }
+            else if (c == '"')
+                {
+                    escaped += R"(\")";
+                }
+            else
+                {
+                    escaped.push_back (c);
+                }
+        }
+    prompt = std::move (escaped);
+}
+
+/**
+ * Renders the prompt with `data` (author, title, description, link,
+ * subtitles), escapes it and renders the HTTP body to an LLM with it.
+ */
+[[nodiscard]] inline std::string
+render_request_body (std::string const &prompt_template,
+                     std::string const &http_body_template,
+                     inja::json const &data)
+{
+    std::string prompt = inja::render (prompt_template, data);
+    escape_prompt (prompt);
+
+    inja::json data_prompt;
+    data_prompt["prompt"] = std::move (prompt);
+    return inja::render (http_body_template, data_prompt);
+}
+
+/**
+ * @class RequestTemplates
+ * @brief The prompt template and the HTTP body template, parsed once per
+ * config instead of on every request.
+ * @description Parsing throws inja::InjaError for a broken template, so that
+ * one is found when the config is loaded rather than on the first video.
+ */
+class RequestTemplates
+{
+    // Rendering by an environment isn't const.
+    mutable inja::Environment env_;
+    inja::Template prompt_;
+    inja::Template http_body_;
+
+  public:
+    RequestTemplates (std::string const &prompt_template,
+                      std::string const &http_body_template)
+        : prompt_ (env_.parse (prompt_template)),
+          http_body_ (env_.parse (http_body_template))
+    {
+    }
+
+    /// Like render_request_body.
+    [[nodiscard]] std::string
+    render (inja::json const &data) const
+    {
+        std::string prompt = env_.render (prompt_, data);
+        escape_prompt (prompt);
+
+        inja::json data_prompt;
+        data_prompt["prompt"] = std::move (prompt);
+        return env_.render (http_body_, data_prompt);
+    }
+
+    /// Like `render`, with the prompt and the body allocated from `memory`.
+    /// The prompt is still copied into the JSON data of the body template.
+    [[nodiscard]] std::pmr::string
+    render (inja::json const &data, std::pmr::memory_resource *memory) const
+    {
+        using Stream = std::basic_ostringstream<
+            char, std::char_traits<char>,
+            std::pmr::polymorphic_allocator<char> >;
+        Stream prompt_stream (std::ios_base::out, memory);
+        env_.render_to (prompt_stream, prompt_, data);
+        std::pmr::string prompt = std::move (prompt_stream).str ();
+        escape_prompt (prompt);
+
+        inja::json data_prompt;
+        data_prompt["prompt"] = std::string_view (prompt);
+        Stream body_stream (std::ios_base::out, memory);
+        env_.render_to (body_stream, http_body_, data_prompt);
+        return std::move (body_stream).str ();
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_PROMPT_HPP_
@@ -0,0 +1,65 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_REGENERATION_QUEUE_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_REGENERATION_QUEUE_HPP_
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <inja/json.hpp>
+
+/**
+ * @class RegenerationQueue
+ * @brief Entries of feeds served with a summary of an older version, which
+ * are to be summarized again.
+ * @description Ordered by `published` of the entries, newest first, since
+ * those are the ones read the most. A video is queued once until `done` is
+ * called for it.
+ */
+class RegenerationQueue
+{
+    // (published, link) -> data of the entry for the prompt.
+    std::map<std::pair<std::string, std::string>, inja::json, std::greater<>>
+        items_;
+    std::set<std::string> queued_;
+
+  public:
+    void
+    push (std::string const &link, inja::json data)
+    {
+        if (not queued_.insert (link).second)
+            {
+                return;
+            }
+        std::string published = data.value ("published", "");
+        items_.emplace (std::pair{std::move (published), link},
+                        std::move (data));
+    }
+
+    [[nodiscard]] std::optional<inja::json>
+    pop ()
+    {
+        if (items_.empty ())
+            {
+                return std::nullopt;
+            }
+        auto node = items_.extract (items_.begin ());
+        return std::move (node.mapped ());
+    }
+
+    void
+    done (std::string const &link)
+    {
+        queued_.erase (link);
+    }
+
+    [[nodiscard]] std::size_t
+    size () const
+    {
+        return items_.size ();
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_REGENERATION_QUEUE_HPP_
@@ -0,0 +1,111 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_RESIZABLE_SEMAPHORE_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_RESIZABLE_SEMAPHORE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include <corral/Semaphore.h>
+#include <corral/corral.h>
+
+/**
+ * @class ResizableSemaphore
+ * @brief corral::Semaphore whose amount of slots can be changed while it's
+ * held, for limits changed by a reload of the config.
+ * @description Growing releases the new slots right away. Shrinking can't
+ * take slots from their holders, so the excess is a debt: slots given back
+ * or found free while the debt is unpaid are swallowed instead of being
+ * handed out. Holders past the new limit finish as they are.
+ */
+class ResizableSemaphore
+{
+    corral::Semaphore semaphore_;
+    std::size_t size_;
+    std::size_t debt_ = 0;
+
+    void
+    release ()
+    {
+        if (debt_ != 0)
+            {
+                --debt_;
+                return;
+            }
+        semaphore_.release ();
+    }
+
+  public:
+    class Lock
+    {
+        ResizableSemaphore *semaphore_;
+
+      public:
+        explicit Lock (ResizableSemaphore &semaphore) : semaphore_ (&semaphore)
+        {
+        }
+
+        Lock (Lock &&other) noexcept
+            : semaphore_ (std::exchange (other.semaphore_, nullptr))
+        {
+        }
+
+        Lock &operator= (Lock &&) = delete;
+        Lock (Lock const &) = delete;
+        Lock &operator= (Lock const &) = delete;
+
+        ~Lock ()
+        {
+            if (semaphore_ != nullptr)
+                {
+                    semaphore_->release ();
+                }
+        }
+    };
+
+    explicit ResizableSemaphore (std::size_t size)
+        : semaphore_ (size), size_ (size)
+    {
+    }
+
+    [[nodiscard]] std::size_t
+    size () const
+    {
+        return size_;
+    }
+
+    corral::Task<Lock>
+    lock ()
+    {
+        for (;;)
+            {
+                co_await semaphore_.acquire ();
+                if (debt_ == 0)
+                    {
+                        co_return Lock (*this);
+                    }
+                --debt_;
+            }
+    }
+
+    void
+    resize (std::size_t size)
+    {
+        if (size < size_)
+            {
+                debt_ += size_ - size;
+            }
+        else
+            {
+                std::size_t const added = size - size_;
+                std::size_t const paid = std::min (debt_, added);
+                debt_ -= paid;
+                for (std::size_t i = paid; i < added; ++i)
+                    {
+                        semaphore_.release ();
+                    }
+            }
+        size_ = size;
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_RESIZABLE_SEMAPHORE_HPP_
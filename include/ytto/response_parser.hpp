@@ -0,0 +1,259 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_RESPONSE_PARSER_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_RESPONSE_PARSER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glaze/core/context.hpp>
+#include <glaze/json.hpp>
+
+#include "ytto/llm_usage.hpp"
+#include "ytto/omega_exception.hpp"
+
+struct ParsedResponse
+{
+    std::string summary;
+    // Unless the LLM didn't report it.
+    std::optional<LlmUsage> usage;
+};
+
+/**
+ * @class ABCResponseParser
+ * @brief Takes a summary out of a response of an LLM.
+ * @description Throws OmegaException<std::string> with the raw response as
+ * data if it can't.
+ *
+ * Besides the parsers below, one can be loaded from a shared library via
+ * Boost::DLL: the library has to export an object of a class derived from
+ * this one as `BOOST_DLL_ALIAS(object, ytto_response_parser)` and be built
+ * with the same compiler and standard library as the app.
+ */
+class ABCResponseParser
+{
+  public:
+    [[nodiscard]] virtual ParsedResponse
+    getResponse (std::string const &raw_json) const = 0;
+
+    virtual ~ABCResponseParser () = default;
+
+  protected:
+    // Only the fields of a schema below are materialized, the rest are
+    // skipped over.
+    static constexpr glz::opts SKIP_UNKNOWN{.error_on_unknown_keys = false};
+    // Besides, reading stops once all fields of the schema are read, so e.g.
+    // `context` of /api/generate isn't even looked at. Arrays are read only
+    // into elements they already have, so it's for schemas without arrays.
+    static constexpr glz::opts PARTIAL_READ{.error_on_unknown_keys = false,
+                                            .partial_read = true};
+
+    template <class Schema, glz::opts Opts>
+    [[nodiscard]] static Schema
+    read (std::string const &raw_json)
+    {
+        Schema parsed{};
+        glz::error_ctx ec = glz::read<Opts> (parsed, raw_json);
+        if (ec)
+            {
+                throw OmegaException<std::string> (
+                    glz::format_error (ec, raw_json), raw_json);
+            }
+        return parsed;
+    }
+};
+
+/// Name of the object exported by plugins, see ABCResponseParser.
+inline constexpr char const *RESPONSE_PARSER_PLUGIN_ALIAS
+    = "ytto_response_parser";
+
+/// Counts and durations (in nanoseconds) from a response of Ollama, which
+/// are the same for all of its endpoints.
+template <class Schema>
+[[nodiscard]] LlmUsage
+ollama_usage (Schema &parsed)
+{
+    return {.model = std::move (parsed.model),
+            .prompt_tokens = parsed.prompt_eval_count,
+            .generated_tokens = parsed.eval_count,
+            .prompt_duration
+            = std::chrono::nanoseconds (parsed.prompt_eval_duration),
+            .generation_duration
+            = std::chrono::nanoseconds (parsed.eval_duration),
+            .load_duration = std::chrono::nanoseconds (parsed.load_duration)};
+}
+
+/// Ollama's /api/chat without streaming.
+class OllamaChatParser final : public ABCResponseParser
+{
+    struct Message
+    {
+        std::string content;
+    };
+
+    struct Schema
+    {
+        std::string model;
+        Message message;
+        std::int64_t load_duration = 0;
+        std::uint64_t prompt_eval_count = 0;
+        std::int64_t prompt_eval_duration = 0;
+        std::uint64_t eval_count = 0;
+        std::int64_t eval_duration = 0;
+    };
+
+  public:
+    [[nodiscard]] ParsedResponse
+    getResponse (std::string const &raw_json) const final
+    {
+        Schema parsed = read<Schema, PARTIAL_READ> (raw_json);
+        return {.summary = std::move (parsed.message.content),
+                .usage = ollama_usage (parsed)};
+    }
+};
+
+/// Ollama's /api/generate without streaming.
+class OllamaGenerateParser final : public ABCResponseParser
+{
+    struct Schema
+    {
+        std::string model;
+        std::string response;
+        std::int64_t load_duration = 0;
+        std::uint64_t prompt_eval_count = 0;
+        std::int64_t prompt_eval_duration = 0;
+        std::uint64_t eval_count = 0;
+        std::int64_t eval_duration = 0;
+    };
+
+  public:
+    [[nodiscard]] ParsedResponse
+    getResponse (std::string const &raw_json) const final
+    {
+        Schema parsed = read<Schema, PARTIAL_READ> (raw_json);
+        return {.summary = std::move (parsed.response),
+                .usage = ollama_usage (parsed)};
+    }
+};
+
+/// /v1/chat/completions of OpenAI and of compatible servers: llama.cpp, vLLM,
+/// Ollama's /v1, OpenRouter and so on.
+class OpenAIChatParser final : public ABCResponseParser
+{
+    struct Message
+    {
+        std::string content;
+    };
+
+    struct Choice
+    {
+        Message message;
+    };
+
+    struct Usage
+    {
+        std::uint64_t prompt_tokens = 0;
+        std::uint64_t completion_tokens = 0;
+    };
+
+    struct Schema
+    {
+        std::string model;
+        std::vector<Choice> choices;
+        std::optional<Usage> usage;
+    };
+
+  public:
+    [[nodiscard]] ParsedResponse
+    getResponse (std::string const &raw_json) const final
+    {
+        Schema parsed = read<Schema, SKIP_UNKNOWN> (raw_json);
+        if (parsed.choices.empty ())
+            {
+                throw OmegaException<std::string> ("No choices in the response",
+                                                   raw_json);
+            }
+        ParsedResponse res;
+        res.summary = std::move (parsed.choices.front ().message.content);
+        if (parsed.usage.has_value ())
+            {
+                res.usage = LlmUsage{
+                    .model = std::move (parsed.model),
+                    .prompt_tokens = parsed.usage->prompt_tokens,
+                    .generated_tokens = parsed.usage->completion_tokens};
+            }
+        return res;
+    }
+};
+
+/// Gemini's generateContent. Text parts of the first candidate are joined.
+class GeminiParser final : public ABCResponseParser
+{
+    struct Part
+    {
+        std::string text;
+    };
+
+    struct Content
+    {
+        std::vector<Part> parts;
+    };
+
+    struct Candidate
+    {
+        Content content;
+    };
+
+    // Named as in JSON.
+    // NOLINTBEGIN(readability-identifier-naming)
+    struct UsageMetadata
+    {
+        std::uint64_t promptTokenCount = 0;
+        std::uint64_t candidatesTokenCount = 0;
+    };
+
+    struct Schema
+    {
+        std::vector<Candidate> candidates;
+        std::optional<UsageMetadata> usageMetadata;
+        std::string modelVersion;
+    };
+    // NOLINTEND(readability-identifier-naming)
+
+  public:
+    [[nodiscard]] ParsedResponse
+    getResponse (std::string const &raw_json) const final
+    {
+        Schema parsed = read<Schema, SKIP_UNKNOWN> (raw_json);
+        if (parsed.candidates.empty ())
+            {
+                throw OmegaException<std::string> (
+                    "No candidates in the response", raw_json);
+            }
+        ParsedResponse res;
+        std::vector<Part> &parts = parsed.candidates.front ().content.parts;
+        if (parts.size () == 1)
+            {
+                res.summary = std::move (parts.front ().text);
+            }
+        else
+            {
+                for (Part const &part : parts)
+                    {
+                        res.summary += part.text;
+                    }
+            }
+        if (parsed.usageMetadata.has_value ())
+            {
+                res.usage = LlmUsage{
+                    .model = std::move (parsed.modelVersion),
+                    .prompt_tokens = parsed.usageMetadata->promptTokenCount,
+                    .generated_tokens
+                    = parsed.usageMetadata->candidatesTokenCount};
+            }
+        return res;
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_RESPONSE_PARSER_HPP_
@@ -0,0 +1,209 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_SUBTITLE_NORMALIZER_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_SUBTITLE_NORMALIZER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class SubtitleNormalizer
+ * @brief Shrinks subtitles before they are put into a prompt.
+ * @description YouTube's auto-generated VTT subtitles are "rolling": every cue
+ * repeats the line of the previous cue, so after stripping of timestamps and
+ * tags every line occurs two or three times in a row. The normalizer:
+ * 1. Squeezes all whitespace into single spaces.
+ * 2. Optionally drops filler tokens like "um", "uh", "[Music]".
+ * 3. Collapses immediately repeated runs of words (a run of at least
+ *    `min_repeat_words` words that is equal to the words right before it).
+ *
+ * Works on already cleaned text, so it is fine to feed it subtitles from the
+ * subtitles' cache.
+ */
+class SubtitleNormalizer
+{
+  public:
+    struct Options
+    {
+        bool collapse_repeats = true;
+        bool drop_filler_words = false;
+        // Repeats shorter than that are kept, since "no no" or "thank you
+        // thank you" are usually said for real.
+        std::size_t min_repeat_words = 3;
+        // Longest run of words that is checked for being a repeat.
+        std::size_t max_repeat_words = 48;
+    };
+
+    struct Result
+    {
+        std::string text;
+        std::size_t bytes_before{};
+        std::size_t bytes_after{};
+        std::size_t words_before{};
+        std::size_t words_after{};
+
+        // Rough estimation of tokens for English text: ~4 bytes per token.
+        [[nodiscard]] std::size_t
+        approx_tokens_before () const noexcept
+        {
+            return (bytes_before + 3) / 4;
+        }
+
+        [[nodiscard]] std::size_t
+        approx_tokens_after () const noexcept
+        {
+            return (bytes_after + 3) / 4;
+        }
+
+        [[nodiscard]] double
+        reduction_percent () const noexcept
+        {
+            if (bytes_before == 0)
+                {
+                    return 0.;
+                }
+            return 100.
+                   * static_cast<double> (bytes_before - bytes_after)
+                   / static_cast<double> (bytes_before);
+        }
+    };
+
+    SubtitleNormalizer () = default;
+
+    explicit SubtitleNormalizer (Options options) : options_ (options) {}
+
+    [[nodiscard]] Result
+    normalize (std::string_view subtitles) const
+    {
+        Result result;
+        result.bytes_before = subtitles.size ();
+
+        std::vector<std::string_view> words = split_words (subtitles);
+        result.words_before = words.size ();
+
+        if (options_.drop_filler_words)
+            {
+                std::erase_if (words, is_filler_word);
+            }
+
+        std::vector<std::string_view> kept;
+        kept.reserve (words.size ());
+        if (options_.collapse_repeats)
+            {
+                collapse_repeats (words, kept);
+            }
+        else
+            {
+                kept = std::move (words);
+            }
+
+        result.words_after = kept.size ();
+        result.text.reserve (subtitles.size ());
+        for (std::string_view word : kept)
+            {
+                if (not result.text.empty ())
+                    {
+                        result.text.push_back (' ');
+                    }
+                result.text.append (word);
+            }
+        result.bytes_after = result.text.size ();
+        return result;
+    }
+
+  private:
+    Options options_;
+
+    [[nodiscard]] static std::vector<std::string_view>
+    split_words (std::string_view text)
+    {
+        std::vector<std::string_view> words;
+        std::size_t pos = 0;
+        while (pos < text.size ())
+            {
+                while (pos < text.size ()
+                       && std::isspace (static_cast<unsigned char> (text[pos])))
+                    {
+                        ++pos;
+                    }
+                std::size_t start = pos;
+                while (pos < text.size ()
+                       && not std::isspace (
+                           static_cast<unsigned char> (text[pos])))
+                    {
+                        ++pos;
+                    }
+                if (pos != start)
+                    {
+                        words.push_back (text.substr (start, pos - start));
+                    }
+            }
+        return words;
+    }
+
+    [[nodiscard]] static bool
+    is_filler_word (std::string_view word)
+    {
+        static constexpr std::array<std::string_view, 12> fillers{
+            "um",      "uh",         "umm",         "uhh",
+            "erm",     "hmm",        "mm",          ">>",
+            "[music]", "[applause]", "[laughter]",  "&nbsp;"};
+
+        while (not word.empty ()
+               && (word.back () == ',' || word.back () == '.'))
+            {
+                word.remove_suffix (1);
+            }
+        if (word.empty () || word.size () > 12)
+            {
+                return false;
+            }
+
+        std::array<char, 12> lowered{};
+        std::ranges::transform (word, lowered.begin (),
+                                [] (unsigned char c)
+                                    { return std::tolower (c); });
+        std::string_view lowered_word (lowered.data (), word.size ());
+        return std::ranges::find (fillers, lowered_word) != fillers.end ();
+    }
+
+    void
+    collapse_repeats (std::vector<std::string_view> const &words,
+                      std::vector<std::string_view> &kept) const
+    {
+        std::size_t i = 0;
+        while (i < words.size ())
+            {
+                std::size_t longest = std::min (
+                    { options_.max_repeat_words, kept.size (),
+                      words.size () - i });
+                std::size_t repeat = 0;
+                for (std::size_t k = longest;
+                     k >= options_.min_repeat_words && k > 0; --k)
+                    {
+                        auto first = words.begin ()
+                                     + static_cast<std::ptrdiff_t> (i);
+                        if (std::equal (first,
+                                        first + static_cast<std::ptrdiff_t> (k),
+                                        kept.end ()
+                                            - static_cast<std::ptrdiff_t> (k)))
+                            {
+                                repeat = k;
+                                break;
+                            }
+                    }
+                if (repeat != 0)
+                    {
+                        i += repeat;
+                        continue;
+                    }
+                kept.push_back (words[i]);
+                ++i;
+            }
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_SUBTITLE_NORMALIZER_HPP_
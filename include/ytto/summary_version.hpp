@@ -0,0 +1,134 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_SUMMARY_VERSION_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_SUMMARY_VERSION_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <boost/hash2/hash_append.hpp>
+#include <boost/hash2/xxhash.hpp>
+#include <fmt/format.h>
+#include <fmt/os.h>
+#include <re2/re2.h>
+
+/**
+ * Name of the model in an HTTP body template, i.e. the value of its first
+ * `"model"` field. Empty if there's none.
+ */
+[[nodiscard]] inline std::string
+model_of_body_template (std::string const &http_body_template)
+{
+    static RE2 const model_re (R"re("model"\s*:\s*"([^"]*)")re");
+    std::string model;
+    RE2::PartialMatch (http_body_template, model_re, &model);
+    return model;
+}
+
+/**
+ * Version of summaries made with a prompt template and a model: a lowercase
+ * hex dump of a hash of both. Summaries of different versions are cached
+ * side by side.
+ */
+[[nodiscard]] inline std::string
+summary_version (std::string const &prompt_template, std::string const &model)
+{
+    boost::hash2::xxhash_64 hash_object;
+    boost::hash2::hash_append (hash_object, {}, prompt_template);
+    boost::hash2::hash_append (hash_object, {}, model);
+    std::uint64_t hash = hash_object.result ();
+    return fmt::format ("{:x}", hash);
+}
+
+/**
+ * Key of a summary of a video in the summaries' cache. An empty version is
+ * the key of summaries cached before summaries had versions.
+ */
+[[nodiscard]] inline std::string
+summary_key (std::string const &link, std::string const &version)
+{
+    if (version.empty ())
+        {
+            return link;
+        }
+    return fmt::format ("{}#{}", link, version);
+}
+
+/// Like summary_key, allocated from `memory`.
+[[nodiscard]] inline std::pmr::string
+summary_key (std::string const &link, std::string const &version,
+             std::pmr::memory_resource *memory)
+{
+    std::pmr::string key (link, memory);
+    if (not version.empty ())
+        {
+            fmt::format_to (std::back_inserter (key), "#{}", version);
+        }
+    return key;
+}
+
+/**
+ * @class SummaryVersions
+ * @brief Registry of versions of summaries ever used with a cache folder.
+ * @description A text file with a line `<version> <model>` per version,
+ * oldest first. Constructing it registers the current version.
+ */
+class SummaryVersions
+{
+    std::vector<std::string> previous_;
+
+  public:
+    SummaryVersions (std::filesystem::path const &file,
+                     std::string const &current, std::string const &model)
+    {
+        std::vector<std::string> known;
+        {
+            std::ifstream ifs (file);
+            std::string line;
+            while (std::getline (ifs, line))
+                {
+                    std::string version = line.substr (0, line.find (' '));
+                    if (not version.empty ())
+                        {
+                            known.push_back (std::move (version));
+                        }
+                }
+        }
+
+        bool const registered
+            = not known.empty () && known.back () == current;
+        for (auto it = known.rbegin (); it != known.rend (); ++it)
+            {
+                if (*it != current
+                    && std::find (previous_.begin (), previous_.end (), *it)
+                           == previous_.end ())
+                    {
+                        previous_.push_back (*it);
+                    }
+            }
+        // Summaries cached before versions existed are the oldest ones.
+        previous_.emplace_back ();
+
+        if (not registered)
+            {
+                fmt::output_file (file.string (),
+                                  fmt::file::WRONLY | fmt::file::CREATE
+                                      | fmt::file::APPEND)
+                    .print ("{} {}\n", current, model);
+            }
+    }
+
+    /// Versions other than the current one, newest first. The last one is
+    /// always the empty version of summaries cached without a version.
+    [[nodiscard]] std::vector<std::string> const &
+    previous () const
+    {
+        return previous_;
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_SUMMARY_VERSION_HPP_
@@ -0,0 +1,376 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_TRACING_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_TRACING_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <glaze/glaze.hpp>
+
+struct SpanRecord
+{
+    std::string_view name;
+    std::string detail;
+    std::uint64_t trace_id_high{};
+    std::uint64_t trace_id_low{};
+    std::uint64_t span_id{};
+    std::uint64_t parent_id{};
+    std::uint64_t lane{};
+    // microseconds since unix epoch
+    std::int64_t start_us{};
+    std::int64_t duration_us{};
+};
+
+/**
+ * @class Tracer
+ * @brief Collects finished spans and exports them as a Chrome trace (the
+ * format of chrome://tracing and https://ui.perfetto.dev) or as OTLP/HTTP
+ * JSON.
+ * @description Keeps the last `capacity` spans for the Chrome trace file and,
+ * if OTLP export is enabled, the spans that were not sent yet. Not thread-safe:
+ * spans are finished on the io_context's thread only. When disabled, spans do
+ * not allocate and do not read clocks.
+ */
+class Tracer
+{
+    bool enabled_ = false;
+    bool keep_for_otlp_ = false;
+    std::size_t capacity_ = 0;
+    std::deque<SpanRecord> recent_;
+    std::vector<SpanRecord> pending_otlp_;
+    std::size_t recorded_since_write_ = 0;
+    std::mt19937_64 random_{std::random_device{}()};
+
+    struct ChromeEvent
+    {
+        std::string_view name;
+        std::string_view cat = "ytto";
+        std::string_view ph = "X";
+        std::int64_t ts{};
+        std::int64_t dur{};
+        std::uint64_t pid = 1;
+        std::uint64_t tid{};
+        std::map<std::string, std::string> args;
+    };
+
+    struct ChromeTrace
+    {
+        std::vector<ChromeEvent> traceEvents;
+        std::string_view displayTimeUnit = "ms";
+    };
+
+    struct OtlpValue
+    {
+        std::string stringValue;
+    };
+
+    struct OtlpAttribute
+    {
+        std::string_view key;
+        OtlpValue value;
+    };
+
+    struct OtlpSpan
+    {
+        std::string traceId;
+        std::string spanId;
+        std::string parentSpanId;
+        std::string_view name;
+        int kind = 1;
+        std::string startTimeUnixNano;
+        std::string endTimeUnixNano;
+        std::vector<OtlpAttribute> attributes;
+    };
+
+    struct OtlpScope
+    {
+        std::string_view name = "ytto";
+    };
+
+    struct OtlpScopeSpans
+    {
+        OtlpScope scope;
+        std::vector<OtlpSpan> spans;
+    };
+
+    struct OtlpResource
+    {
+        std::vector<OtlpAttribute> attributes;
+    };
+
+    struct OtlpResourceSpans
+    {
+        OtlpResource resource;
+        std::vector<OtlpScopeSpans> scopeSpans;
+    };
+
+    struct OtlpExport
+    {
+        std::vector<OtlpResourceSpans> resourceSpans;
+    };
+
+  public:
+    void
+    enable (std::size_t capacity, bool keep_for_otlp)
+    {
+        enabled_ = true;
+        capacity_ = capacity;
+        keep_for_otlp_ = keep_for_otlp;
+    }
+
+    [[nodiscard]] bool
+    enabled () const noexcept
+    {
+        return enabled_;
+    }
+
+    [[nodiscard]] std::uint64_t
+    new_id ()
+    {
+        std::uint64_t id = 0;
+        while (id == 0)
+            {
+                id = random_ ();
+            }
+        return id;
+    }
+
+    void
+    record (SpanRecord record)
+    {
+        if (keep_for_otlp_)
+            {
+                pending_otlp_.push_back (record);
+            }
+        if (capacity_ != 0)
+            {
+                if (recent_.size () == capacity_)
+                    {
+                        recent_.pop_front ();
+                    }
+                recent_.push_back (std::move (record));
+                ++recorded_since_write_;
+            }
+    }
+
+    /// Whether there is something new for the Chrome trace file.
+    [[nodiscard]] bool
+    has_new_spans () const noexcept
+    {
+        return recorded_since_write_ != 0;
+    }
+
+    [[nodiscard]] std::string
+    to_chrome_trace ()
+    {
+        recorded_since_write_ = 0;
+        ChromeTrace trace;
+        trace.traceEvents.reserve (recent_.size ());
+        for (SpanRecord const &span : recent_)
+            {
+                ChromeEvent event{.name = span.name,
+                                  .ts = span.start_us,
+                                  .dur = span.duration_us,
+                                  .tid = span.lane,
+                                  .args = {}};
+                event.args["trace_id"] = hex_trace_id (span);
+                event.args["span_id"] = fmt::format ("{:016x}", span.span_id);
+                if (span.parent_id != 0)
+                    {
+                        event.args["parent_id"]
+                            = fmt::format ("{:016x}", span.parent_id);
+                    }
+                if (not span.detail.empty ())
+                    {
+                        event.args["detail"] = span.detail;
+                    }
+                trace.traceEvents.push_back (std::move (event));
+            }
+        std::string buffer;
+        auto ec = glz::write_json (trace, buffer);
+        if (ec)
+            {
+                return R"({"traceEvents":[]})";
+            }
+        return buffer;
+    }
+
+    /// Takes spans that were not exported yet as a body of an OTLP/HTTP JSON
+    /// request to `/v1/traces` of a collector. Empty if there is nothing new.
+    [[nodiscard]] std::string
+    take_otlp_json ()
+    {
+        if (pending_otlp_.empty ())
+            {
+                return {};
+            }
+        OtlpScopeSpans scope_spans;
+        scope_spans.spans.reserve (pending_otlp_.size ());
+        for (SpanRecord const &span : pending_otlp_)
+            {
+                OtlpSpan otlp_span{
+                    .traceId = hex_trace_id (span),
+                    .spanId = fmt::format ("{:016x}", span.span_id),
+                    .parentSpanId
+                    = span.parent_id == 0
+                          ? std::string ()
+                          : fmt::format ("{:016x}", span.parent_id),
+                    .name = span.name,
+                    .startTimeUnixNano
+                    = fmt::format ("{}", span.start_us * 1000),
+                    .endTimeUnixNano = fmt::format (
+                        "{}", (span.start_us + span.duration_us) * 1000),
+                    .attributes = {},
+                };
+                if (not span.detail.empty ())
+                    {
+                        otlp_span.attributes.push_back (
+                            {.key = "ytto.detail",
+                             .value = {.stringValue = span.detail}});
+                    }
+                scope_spans.spans.push_back (std::move (otlp_span));
+            }
+        pending_otlp_.clear ();
+
+        OtlpExport otlp_export;
+        otlp_export.resourceSpans.push_back (
+            {.resource = {.attributes = {{.key = "service.name",
+                                          .value = {.stringValue = "ytto"}}}},
+             .scopeSpans = {std::move (scope_spans)}});
+        std::string buffer;
+        auto ec = glz::write_json (otlp_export, buffer);
+        if (ec)
+            {
+                return {};
+            }
+        return buffer;
+    }
+
+  private:
+    static std::string
+    hex_trace_id (SpanRecord const &span)
+    {
+        return fmt::format ("{:016x}{:016x}", span.trace_id_high,
+                            span.trace_id_low);
+    }
+};
+
+/**
+ * @class Span
+ * @brief A timed stage of processing. Recorded into a Tracer on destruction.
+ * @description `Span::root` starts a new trace (one per feed), `child` starts
+ * a nested stage. A child with `new_lane` is drawn on its own row in the
+ * Chrome trace viewer, which is used for entries of a feed, since they are
+ * processed concurrently and would overlap otherwise.
+ */
+class Span
+{
+    Tracer *tracer_ = nullptr;
+    SpanRecord record_;
+    std::chrono::steady_clock::time_point start_;
+
+    Span (Tracer &tracer, std::string_view name, std::uint64_t trace_id_high,
+          std::uint64_t trace_id_low, std::uint64_t parent_id,
+          std::uint64_t lane)
+        : tracer_ (&tracer), start_ (std::chrono::steady_clock::now ())
+    {
+        record_.name = name;
+        record_.trace_id_high = trace_id_high;
+        record_.trace_id_low = trace_id_low;
+        record_.parent_id = parent_id;
+        record_.span_id = tracer.new_id ();
+        record_.lane = lane == 0 ? record_.span_id : lane;
+        record_.start_us
+            = std::chrono::duration_cast<std::chrono::microseconds> (
+                  std::chrono::system_clock::now ().time_since_epoch ())
+                  .count ();
+    }
+
+  public:
+    /// A span that records nothing.
+    Span () = default;
+
+    [[nodiscard]] static Span
+    root (Tracer &tracer, std::string_view name)
+    {
+        if (not tracer.enabled ())
+            {
+                return {};
+            }
+        return {tracer, name, tracer.new_id (), tracer.new_id (), 0, 0};
+    }
+
+    [[nodiscard]] Span
+    child (std::string_view name, bool new_lane = false) const
+    {
+        if (tracer_ == nullptr)
+            {
+                return {};
+            }
+        return {*tracer_,
+                name,
+                record_.trace_id_high,
+                record_.trace_id_low,
+                record_.span_id,
+                new_lane ? 0 : record_.lane};
+    }
+
+    /// Attaches a free-form text to the span, e.g. a link of a video.
+    void
+    annotate (std::string_view detail)
+    {
+        if (tracer_ != nullptr)
+            {
+                record_.detail = detail;
+            }
+    }
+
+    /// Records the span now instead of on destruction.
+    void
+    end ()
+    {
+        if (tracer_ == nullptr)
+            {
+                return;
+            }
+        record_.duration_us
+            = std::chrono::duration_cast<std::chrono::microseconds> (
+                  std::chrono::steady_clock::now () - start_)
+                  .count ();
+        tracer_->record (std::move (record_));
+        tracer_ = nullptr;
+    }
+
+    Span (Span &&other) noexcept
+        : tracer_ (std::exchange (other.tracer_, nullptr)),
+          record_ (std::move (other.record_)), start_ (other.start_)
+    {
+    }
+
+    Span &
+    operator= (Span &&other) noexcept
+    {
+        if (this != &other)
+            {
+                end ();
+                tracer_ = std::exchange (other.tracer_, nullptr);
+                record_ = std::move (other.record_);
+                start_ = other.start_;
+            }
+        return *this;
+    }
+
+    Span (Span const &) = delete;
+    Span &operator= (Span const &) = delete;
+
+    ~Span () { end (); }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_TRACING_HPP_
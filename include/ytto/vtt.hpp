@@ -0,0 +1,121 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_VTT_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_VTT_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// hh:mm:ss.mmm --> hh:mm:ss.mmm
+inline bool
+vtt_is_timing (std::string_view line)
+{
+    static constexpr std::string_view pattern = "00:00:00.000 --> 00:00:00.000";
+    if (line.size () < pattern.size ())
+        {
+            return false;
+        }
+    for (std::size_t i = 0; i < pattern.size (); ++i)
+        {
+            char const c = line[i];
+            switch (pattern[i])
+                {
+                case '0':
+                    if (std::isdigit (static_cast<unsigned char> (c)) == 0)
+                        {
+                            return false;
+                        }
+                    break;
+                case '.':
+                    break;
+                default:
+                    if (c != pattern[i])
+                        {
+                            return false;
+                        }
+                }
+        }
+    return true;
+}
+
+inline bool
+vtt_is_cue_number (std::string_view line)
+{
+    return not line.empty () && line.size () <= 3
+           && std::ranges::all_of (line, [] (char c) {
+                  return std::isdigit (static_cast<unsigned char> (c)) != 0;
+              });
+}
+
+inline bool
+vtt_is_blank (std::string_view line)
+{
+    return std::ranges::all_of (line, [] (char c) {
+        return std::isspace (static_cast<unsigned char> (c)) != 0;
+    });
+}
+
+/**
+ * Turns WebVTT subtitles into text the way the sed pipeline of older versions
+ * did, so that subtitles cached by them look the same: timings, cue numbers,
+ * tags, blank lines and the first three lines (the header) are dropped,
+ * quotes are escaped by a backslash, and the rest is joined by spaces, each
+ * line followed by one.
+ */
+inline std::string
+vtt_to_text (std::string_view vtt)
+{
+    std::string res;
+    res.reserve (vtt.size ());
+    std::size_t number = 0;
+    while (not vtt.empty ())
+        {
+            std::size_t const end = vtt.find ('\n');
+            std::string_view line = vtt.substr (0, end);
+            vtt.remove_prefix (end == std::string_view::npos ? vtt.size ()
+                                                             : end + 1);
+            ++number;
+            if (vtt_is_timing (line) || vtt_is_cue_number (line))
+                {
+                    continue;
+                }
+
+            std::string untagged;
+            untagged.reserve (line.size ());
+            bool in_tag = false;
+            for (std::size_t i = 0; i < line.size (); ++i)
+                {
+                    char const c = line[i];
+                    if (in_tag)
+                        {
+                            in_tag = c != '>';
+                            continue;
+                        }
+                    // Like <[^>]*>: an unclosed '<' is kept.
+                    if (c == '<' && line.find ('>', i) != std::string_view::npos)
+                        {
+                            in_tag = true;
+                            continue;
+                        }
+                    untagged += c;
+                }
+            if (vtt_is_blank (untagged) || number <= 3)
+                {
+                    continue;
+                }
+
+            for (char c : untagged)
+                {
+                    if (c == '\'' || c == '"')
+                        {
+                            res += '\\';
+                        }
+                    res += c;
+                }
+            res += ' ';
+        }
+    return res;
+}
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_VTT_HPP_
@@ -0,0 +1,227 @@
+#ifndef INCLUDE_YOUTUBETOOLLAMA_YT_DLP_WORKER_HPP_
+#define INCLUDE_YOUTUBETOOLLAMA_YT_DLP_WORKER_HPP_
+
+#include <charconv>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/process.hpp>
+#include <boost/process/v2/shell.hpp>
+#include <corral/asio.h>
+#include <corral/corral.h>
+#include <glaze/glaze.hpp>
+
+/**
+ * @class YtDlpWorker
+ * @brief One long-lived process of scripts/ytto_yt_dlp_worker.py, which
+ * fetches subtitles of a video per request.
+ * @description A request is a line of JSON on stdin of the worker, an answer
+ * is a line "ok <length>", "error <length>" or "none 0" (no subtitles in any
+ * of the languages) on its stdout followed by `length` bytes of subtitles or
+ * of an error. Subtitles are std::nullopt for "none".
+ *
+ * `fetch` returns std::nullopt if the worker died or answered garbage. Then
+ * the worker is of no use anymore, as is a worker whose `fetch` was
+ * cancelled midway, since an answer may be left in its pipe. The destructor
+ * kills the process.
+ */
+class YtDlpWorker
+{
+    struct Request
+    {
+        std::string url;
+        std::string language;
+    };
+
+    boost::asio::writable_pipe in_;
+    boost::asio::readable_pipe out_;
+    boost::process::process process_;
+    std::string buffer_;
+    std::size_t jobs_ = 0;
+
+    static boost::process::process
+    spawn (boost::asio::io_context &ioc, std::string const &command,
+           boost::asio::writable_pipe &in, boost::asio::readable_pipe &out)
+    {
+        boost::process::shell cmd = boost::process::shell (command);
+        auto exe = cmd.exe ();
+        // stderr is inherited: tracebacks of a crashed worker end up in ours.
+        return boost::process::process (
+            ioc, exe, cmd.args (),
+            boost::process::process_stdio{.in = in, .out = out, .err = {}});
+    }
+
+  public:
+    YtDlpWorker (boost::asio::io_context &ioc, std::string const &command)
+        : in_ (ioc), out_ (ioc), process_ (spawn (ioc, command, in_, out_))
+    {
+    }
+
+    YtDlpWorker (YtDlpWorker const &) = delete;
+    YtDlpWorker &operator= (YtDlpWorker const &) = delete;
+
+    /// Requests served, whether with subtitles or with an error.
+    [[nodiscard]] std::size_t
+    jobs () const
+    {
+        return jobs_;
+    }
+
+    corral::Task<std::optional<
+        std::expected<std::optional<std::string>, std::string> > >
+    fetch (std::string const &url, std::string const &language)
+    {
+        std::string request;
+        if (glz::write_json (Request{.url = url, .language = language},
+                             request))
+            {
+                co_return std::unexpected ("Failed to serialize a request "
+                                           "to a yt-dlp worker");
+            }
+        request += '\n';
+        auto [ec_write, written] = co_await boost::asio::async_write (
+            in_, boost::asio::buffer (request), corral::asio_nothrow_awaitable);
+        if (ec_write)
+            {
+                co_return std::nullopt;
+            }
+
+        auto [ec_header, header_size] = co_await boost::asio::async_read_until (
+            out_, boost::asio::dynamic_buffer (buffer_), '\n',
+            corral::asio_nothrow_awaitable);
+        if (ec_header)
+            {
+                co_return std::nullopt;
+            }
+        std::string_view header (buffer_.data (), header_size - 1);
+        std::size_t const space = header.find (' ');
+        if (space == std::string_view::npos)
+            {
+                co_return std::nullopt;
+            }
+        std::string_view const status = header.substr (0, space);
+        std::string_view const length_str = header.substr (space + 1);
+        std::size_t length = 0;
+        auto [ptr, ec_length] = std::from_chars (
+            length_str.data (), length_str.data () + length_str.size (), length);
+        if (ec_length != std::errc{}
+            || ptr != length_str.data () + length_str.size ()
+            || (status != "ok" && status != "error" && status != "none"))
+            {
+                co_return std::nullopt;
+            }
+
+        if (buffer_.size () < header_size + length)
+            {
+                auto [ec_body, body_size] = co_await boost::asio::async_read (
+                    out_, boost::asio::dynamic_buffer (buffer_),
+                    boost::asio::transfer_exactly (header_size + length
+                                                   - buffer_.size ()),
+                    corral::asio_nothrow_awaitable);
+                if (ec_body)
+                    {
+                        co_return std::nullopt;
+                    }
+            }
+        std::string payload = buffer_.substr (header_size, length);
+        buffer_.erase (0, header_size + length);
+        ++jobs_;
+
+        if (status == "error")
+            {
+                co_return std::unexpected (std::move (payload));
+            }
+        if (status == "none")
+            {
+                co_return std::optional<std::string>{};
+            }
+        co_return std::optional<std::string>{std::move (payload)};
+    }
+};
+
+/**
+ * @class YtDlpWorkerPool
+ * @brief Workers of --yt-dlp-worker, reused from one video to the next.
+ * @description `size` workers are started right away, so that their
+ * interpreters are warm by the first video. A busy worker is taken out of the
+ * pool; if none is idle, e.g. since one died, a fresh one is started.
+ *
+ * A worker is replaced after `max_jobs` videos (0 means never), which bounds
+ * memory leaked by extractors. A worker that dies during a video is replaced
+ * and the video is tried once more on a fresh worker; if that one dies too,
+ * the video is likely the cause, and `fetch` fails.
+ */
+class YtDlpWorkerPool
+{
+    boost::asio::io_context &ioc_;
+    std::string command_;
+    std::size_t max_jobs_;
+    std::vector<std::unique_ptr<YtDlpWorker> > idle_;
+
+  public:
+    YtDlpWorkerPool (boost::asio::io_context &ioc, std::string command,
+                     std::size_t size, std::size_t max_jobs)
+        : ioc_ (ioc), command_ (std::move (command)), max_jobs_ (max_jobs)
+    {
+        idle_.reserve (size);
+        for (std::size_t i = 0; i < size; ++i)
+            {
+                idle_.push_back (
+                    std::make_unique<YtDlpWorker> (ioc_, command_));
+            }
+    }
+
+    corral::Task<std::expected<std::optional<std::string>, std::string> >
+    fetch (std::string const &url, std::string const &language)
+    {
+        for (int attempt = 0;; ++attempt)
+            {
+                std::unique_ptr<YtDlpWorker> worker = take ();
+                auto res = co_await worker->fetch (url, language);
+                if (res.has_value ())
+                    {
+                        give_back (std::move (worker));
+                        co_return std::move (*res);
+                    }
+                if (attempt == 1)
+                    {
+                        co_return std::unexpected (
+                            "A yt-dlp worker died twice on " + url);
+                    }
+            }
+    }
+
+  private:
+    std::unique_ptr<YtDlpWorker>
+    take ()
+    {
+        if (idle_.empty ())
+            {
+                return std::make_unique<YtDlpWorker> (ioc_, command_);
+            }
+        std::unique_ptr<YtDlpWorker> worker = std::move (idle_.back ());
+        idle_.pop_back ();
+        return worker;
+    }
+
+    void
+    give_back (std::unique_ptr<YtDlpWorker> worker)
+    {
+        if (max_jobs_ != 0 && worker->jobs () >= max_jobs_)
+            {
+                idle_.push_back (
+                    std::make_unique<YtDlpWorker> (ioc_, command_));
+                return;
+            }
+        idle_.push_back (std::move (worker));
+    }
+};
+
+#endif // INCLUDE_YOUTUBETOOLLAMA_YT_DLP_WORKER_HPP_
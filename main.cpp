@@ -1,7 +1,24 @@
 
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -21,6 +38,7 @@
 #include <boost/beast/http/verb.hpp>
 #include <boost/beast/ssl.hpp>
 #include <boost/date_time.hpp>
+#include <boost/dll/import.hpp>
 #include <boost/process.hpp>
 #include <boost/process/v2/shell.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -29,6 +47,7 @@
 #include <boost/range/iterator_range_core.hpp>
 #include <boost/stacktrace.hpp>
 #include <boost/url.hpp>
+#include <corral/Event.h>
 #include <corral/Nursery.h>
 #include <corral/Semaphore.h>
 #include <corral/asio.h>
@@ -58,43 +77,182 @@
 #include "ytto/boost_stacktrace_format.hpp"
 #include "ytto/cache.hpp"
 #include "ytto/cache_file.hpp"
-#include "ytto/ollama_parser.hpp"
+#include "ytto/cache_janitor.hpp"
+#include "ytto/failure_cache.hpp"
+#ifdef YTTO_WITH_LMDB
+#include "ytto/cache_lmdb.hpp"
+#endif
+#include "ytto/feed.hpp"
+#ifdef YTTO_WITH_NGHTTP2
+#include "ytto/http2_client.hpp"
+#endif
+#include "ytto/job_journal.hpp"
+#include "ytto/llm_usage.hpp"
+#include "ytto/log_payload.hpp"
+#include "ytto/metrics.hpp"
+#include "ytto/no_subtitles_cache.hpp"
 #include "ytto/omega_exception.hpp"
+#include "ytto/prompt.hpp"
+#include "ytto/regeneration_queue.hpp"
+#include "ytto/resizable_semaphore.hpp"
+#include "ytto/response_parser.hpp"
+#include "ytto/subtitle_normalizer.hpp"
+#include "ytto/summary_version.hpp"
+#include "ytto/tracing.hpp"
+#include "ytto/vtt.hpp"
+#include "ytto/yt_dlp_worker.hpp"
 
 template <typename T> struct Debug;
 
 quill::Logger* logger;
+Metrics metrics;
+LlmUsageMetrics llm_usage;
+Tracer tracer;
+PayloadLog payload_log;
+// Set when --job-journal is given.
+JobJournal* journal = nullptr;
+// Set unless --regenerate-jobs is 0.
+RegenerationQueue* regeneration_queue = nullptr;
+#ifdef YTTO_WITH_NGHTTP2
+// Set when --http2 is given.
+Http2Pool* http2_pool = nullptr;
+#endif
+// Set when --yt-dlp-worker is given.
+YtDlpWorkerPool* yt_dlp_workers = nullptr;
+// Set unless --no-subtitles-ttl-hours is 0.
+NoSubtitlesCache* no_subtitles = nullptr;
+// Set unless --retry-backoff-minutes is 0.
+FailureCache* failures = nullptr;
+
+// Logs a preview of a large payload, if the level is enabled and the payload
+// is in the sample of --log-payload-sample. `payload` is evaluated only then.
+#define LOG_PAYLOAD(level, description, payload)                              \
+    do                                                                        \
+        {                                                                     \
+            if (logger->should_log_statement<quill::LogLevel::level>()        \
+                && payload_log.sample())                                      \
+                {                                                             \
+                    auto const& log_payload_value = (payload);                \
+                    std::string_view log_payload_view(log_payload_value);     \
+                    LOG_DYNAMIC(logger, quill::LogLevel::level,               \
+                                description ": {} [{} more bytes]",           \
+                                payload_log.head(log_payload_view),           \
+                                payload_log.cut(log_payload_view));           \
+                }                                                             \
+        }                                                                     \
+    while (false)
 
 constexpr auto HTTP_MAX_TIME_TIMEOUT_RFC = std::chrono::seconds(120);
 constexpr auto MAX_PROMPT_TIME = std::chrono::minutes(10);
 constexpr int HTTP_VERSION_TO_USE = 11;
 constexpr size_t MAX_EXPECTED_CHARACTERS = 128000;
 constexpr uint16_t SERVER_DEFAULT_PORT = 8000;
+constexpr size_t MAX_CONNECTIONS_DEFAULT = 256;
+constexpr size_t REQUEST_HEADER_LIMIT_DEFAULT = size_t{8} << 10;
+// A feed of YouTube is tens of kilobytes.
+constexpr size_t REQUEST_BODY_LIMIT_DEFAULT = size_t{1} << 20;
+constexpr size_t REQUEST_TIMEOUT_SECONDS_DEFAULT = 30;
+constexpr size_t RESPONSE_TIMEOUT_SECONDS_DEFAULT = 60;
 constexpr size_t MAX_CONCURRENT_YTDLP_DEFAULT = 5;
+constexpr size_t YT_DLP_WORKER_JOBS_DEFAULT = 100;
+// Auto-generated subtitles of a fresh video may take a few hours to appear.
+constexpr size_t NO_SUBTITLES_TTL_HOURS_DEFAULT = 12;
+constexpr size_t RETRY_BACKOFF_MINUTES_DEFAULT = 10;
+constexpr size_t RETRY_BACKOFF_MAX_HOURS_DEFAULT = 24;
 constexpr size_t MAX_CONCURRENT_OLLAMA_DEFAULT = 6;
+// Retry-After of feeds refused by an overloaded server.
+constexpr auto OVERLOAD_RETRY_AFTER = std::chrono::seconds(30);
+constexpr size_t TRACE_BUFFER_SPANS_DEFAULT = 65536;
+constexpr size_t TRACE_EXPORT_INTERVAL_SECONDS_DEFAULT = 10;
+constexpr auto JOURNAL_FLUSH_INTERVAL = std::chrono::seconds(1);
+constexpr size_t LLM_USAGE_LOG_INTERVAL_SECONDS_DEFAULT = 300;
+constexpr auto REGENERATION_POLL_INTERVAL = std::chrono::seconds(1);
+constexpr size_t REGENERATE_JOBS_DEFAULT = 1;
+// Enough for bookkeeping of a feed of YouTube, which has 15 entries.
+constexpr size_t FEED_ARENA_BYTES = 8 * 1024;
+constexpr size_t LMDB_MAP_SIZE_DEFAULT = size_t{16} << 30;
+constexpr auto CACHE_JANITOR_STEP_INTERVAL = std::chrono::milliseconds(10);
+constexpr auto CACHE_JANITOR_PASS_INTERVAL = std::chrono::minutes(5);
 
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace net = boost::asio;
 namespace ssl = net::ssl;
 
+// NOLINTNEXTLINE(performance-enum-size)
+enum class CacheBackend : int
+{
+    Files,
+    Lmdb,
+};
+
 struct Config
 {
+    // Comma-separated, as given to yt-dlp.
     std::string language;
+    // Split, the most preferred first.
+    std::vector<std::string> languages;
     std::string prompt_template;
     std::string http_body_template;
+    // Both templates above, parsed.
+    std::shared_ptr<RequestTemplates const> request_templates;
+    // The "model" of http_body_template.
+    std::string model;
+    // See summary_version.hpp
+    std::string summary_version;
+    std::vector<std::string> stale_summary_versions;
     boost::url url;
+    boost::url feed_source;
     beast::http::verb method;
     beast::http::fields headers;
+    std::shared_ptr<ABCResponseParser const> response_parser;
+    // Parses responses instead of `response_parser` if not empty.
+    std::string response_parser_command;
+    // Fetches subtitles by a pool of these instead of yt-dlp per video if not
+    // empty.
+    std::string yt_dlp_worker;
+    size_t yt_dlp_worker_jobs{};
+    size_t no_subtitles_ttl_hours{};
+    // Backoff of retries of failed videos, base 0 means no backoff.
+    FailureCache::Options retry_backoff;
     std::filesystem::path cache_file;
     std::filesystem::path cache_subtitles_file;
+    CacheBackend cache_backend;
+    size_t lmdb_map_size{};
+    CacheJanitor::Options cache_janitor;
+    CacheJanitor::Options cache_subtitles_janitor;
     std::filesystem::path log_file;
     quill::LogLevel log_level;
+    std::filesystem::path trace_file;
+    std::filesystem::path job_journal_file;
+    std::filesystem::path daemon_socket;
+    boost::url otlp_url;
+    size_t trace_buffer_spans{};
+    size_t trace_export_interval_seconds{};
+    size_t feed_deadline_seconds{};
+    size_t llm_usage_log_interval_seconds{};
+    size_t regenerate_jobs{};
     size_t concurrency_yt_dlp{};
     size_t concurrency_ollama{};
+    size_t pipeline_queue{};
+    // Admission of feeds by a server, 0 means no limit.
+    size_t max_concurrent_feeds{};
+    size_t max_queued_jobs{};
+    size_t max_connections{};
+    size_t request_header_limit{};
+    size_t request_body_limit{};
+    size_t request_timeout_seconds{};
+    size_t response_timeout_seconds{};
     uint16_t server_port{};
     bool proceed_with_shorts{};
     bool enable_server{};
+    bool keep_raw_subtitles{};
+    bool drop_filler_words{};
+    bool http2{};
+    bool yt_dlp_batch{};
+    bool overload_cached_only{};
+    // Drain the regeneration queue in stdin mode too.
+    bool regenerate_stale{};
 };
 
 struct EntryData
@@ -120,77 +278,246 @@ enum class ReturnCodes : int
     FailStandardException = 5,
     FailParsePromptResult = 6,
     FailInitializationLogger = 7,
+    FailDaemon = 8,
 
 };
 
 namespace
 {
+    /// Config of feeds starting now. A reload swaps it, while feeds being
+    /// processed keep the one they started with. Set by main.
+    std::shared_ptr<Config const> current_config;
+    /// Set by main, so that a reload parses the same command line again.
+    std::vector<char const*> command_line;
+
+    corral::Task<std::string> read_pipe(net::readable_pipe& p)
+    {
+        std::string res;
+        std::array<char, 4096> buf;
+        for (;;)
+            {
+                auto [error_code, received_size] = co_await p.async_read_some(
+                    net::buffer(buf), corral::asio_nothrow_awaitable);
+                if (received_size)
+                    {
+                        res.append(buf.data(), received_size);
+                    }
+                if (error_code)
+                    {
+                        co_return res;
+                    }
+            }
+    }
+
+    corral::Task<int> wait_process(boost::process::process& p)
+    {
+        auto [ec, exit_code]
+            = co_await p.async_wait(corral::asio_nothrow_awaitable);
+        co_return exit_code;
+    }
 
-    corral::Task<std::expected<std::string, std::string>> get_subtitles(
-        auto& ioc, std::string const& link, Config const& cfg)
+    /// Subtitles of a video in the most preferred language of --language,
+    /// std::nullopt if it has none in any of them.
+    using Subtitles = std::optional<std::string>;
+
+    // Bodies of requests to an LLM and of its responses, allocated from the
+    // arena of the feed when there's one.
+    using PmrStringBody
+        = http::basic_string_body<char, std::char_traits<char>,
+                                  std::pmr::polymorphic_allocator<char>>;
+
+    /**
+     * Of files of subtitles of a video, named `<id>.<language>.vtt` by
+     * yt-dlp, reads the one in the most preferred language as text.
+     * Languages are regexes, like in --sub-lang of yt-dlp.
+     */
+    Subtitles read_preferred_subtitles(std::vector<std::string> const& files,
+                                       Config const& cfg)
+    {
+        for (auto const& language : cfg.languages)
+            {
+                RE2 const language_re(language);
+                for (auto const& file : files)
+                    {
+                        std::filesystem::path const path(file);
+                        std::string const file_language
+                            = path.stem().extension().string();
+                        if (file_language.empty()
+                            || not RE2::FullMatch(file_language.substr(1),
+                                                  language_re))
+                            {
+                                continue;
+                            }
+                        std::ifstream ifs(path);
+                        std::string vtt(std::istreambuf_iterator<char>(ifs),
+                                        std::istreambuf_iterator<char>{});
+                        if (not vtt.empty())
+                            {
+                                return vtt_to_text(vtt);
+                            }
+                    }
+            }
+        return std::nullopt;
+    }
+
+    struct YtDlpExit
     {
+        int exit_code;
+        std::string std_err;
+    };
+
+    /**
+     * Runs one yt-dlp for `links` with all languages of --language at once.
+     * yt-dlp writes subtitles of every video into a temporary folder and
+     * prints the link and the files of a video as soon as they are written,
+     * so `on_video` gets subtitles of a video while yt-dlp goes on with the
+     * rest. Videos yt-dlp failed on are only in its stderr.
+     */
+    corral::Task<std::expected<YtDlpExit, std::string>> run_yt_dlp(
+        auto& ioc, std::vector<std::string> const& links, Config const& cfg,
+        std::function<void(std::string const&, Subtitles)> const& on_video)
+    {
+        std::string folder_template
+            = (std::filesystem::temp_directory_path() / "ytto-XXXXXX")
+                  .string();
+        if (::mkdtemp(folder_template.data()) == nullptr)
+            {
+                co_return std::unexpected(
+                    fmt::format("Failed to create a folder for yt-dlp: {}",
+                                std::strerror(errno)));
+            }
+        struct RemoveFolder
+        {
+            std::filesystem::path path;
+            ~RemoveFolder()
+            {
+                std::error_code ec;
+                std::filesystem::remove_all(path, ec);
+            }
+        } folder{folder_template};
+
+        // Links are passed as arguments rather than through a shell, so
+        // nothing in them is ever run.
+        auto const exe = boost::process::environment::find_executable("yt-dlp");
+        if (exe.empty())
+            {
+                co_return std::unexpected("yt-dlp is not found in PATH");
+            }
+        std::vector<std::string> args{
+            "-q",
+            "--no-progress",
+            "--no-warnings",
+            "--ignore-errors",
+            "--skip-download",
+            "--write-subs",
+            "--write-auto-subs",
+            "--sub-lang",
+            cfg.language,
+            "--convert-subs",
+            "vtt",
+            "-P",
+            folder.path.string(),
+            "-o",
+            "%(id)s.%(ext)s",
+            "--exec",
+            "before_dl:echo %(original_url)q "
+            "%(requested_subtitles.:.filepath)#q",
+            "--"};
+        args.insert(args.end(), links.begin(), links.end());
+
         net::readable_pipe rp{ioc};
         net::readable_pipe rp_err{ioc};
-        boost::process::shell cmd_get_subtitles = boost::process::shell(
-            R"(yt-dlp -q --no-progress --no-warnings --skip-download --write-subs --write-auto-subs  --sub-lang )"
-            + cfg.language
-            + R"( --convert-subs vtt --exec before_dl:"cat %(requested_subtitles.:.filepath)#q | sed -e '/^[0-9][0-9]:[0-9][0-9]:[0-9][0-9].[0-9][0-9][0-9] --> [0-9][0-9]:[0-9][0-9]:[0-9][0-9].[0-9][0-9][0-9]/d' -e '/^[[:digit:]]\{1,3\}\$/d' -e 's/<[^>]*>//g' -e '/^[[:space:]]*$/d' -e '1,3d' -e \"s/'/\\\\'/g\" -e 's/\"/\\\"/g' | sed -z 's/\n/ /g' && rm %(requested_subtitles.:.filepath)#q " ')"
-            + link + "'");
-        auto exe = cmd_get_subtitles.exe();
         auto proc = boost::process::process(
-            ioc, exe, cmd_get_subtitles.args(),
+            ioc, exe, args,
             boost::process::process_stdio{
                 .in = {/* in to default */}, .out = rp, .err = rp_err});
 
-        auto read_loop = [](net::readable_pipe& p) -> corral::Task<std::string>
+        // Lines of "<link> <file>...", <file> is NA if there're no subtitles.
+        auto const read_videos = [&]() -> corral::Task<void>
             {
-                std::string res;
-                std::array<char, 4096> buf;
+                std::string buffer;
                 for (;;)
                     {
-                        auto [error_code, received_size]
-                            = co_await p.async_read_some(
-                                net::buffer(buf),
-                                corral::asio_nothrow_awaitable);
-                        if (received_size)
+                        auto [ec, size] = co_await net::async_read_until(
+                            rp, net::dynamic_buffer(buffer), '\n',
+                            corral::asio_nothrow_awaitable);
+                        if (ec)
                             {
-                                res.append(buf.data(), received_size);
+                                co_return;
                             }
-                        if (error_code)
+                        std::string line = buffer.substr(0, size - 1);
+                        buffer.erase(0, size);
+
+                        std::vector<std::string> fields;
+                        boost::algorithm::split(
+                            fields, line, [](char c) { return c == ' '; },
+                            boost::algorithm::token_compress_on);
+                        if (fields.empty() || fields.front().empty())
                             {
-                                co_return res;
+                                continue;
                             }
+                        std::string const link = fields.front();
+                        fields.erase(fields.begin());
+                        on_video(link, read_preferred_subtitles(fields, cfg));
                     }
             };
 
-        auto wait_proc = [](boost::process::process& p) -> corral::Task<int>
+        auto [done, exit_code, std_err_of_the_process] = co_await corral::allOf(
+            read_videos(), wait_process(proc), read_pipe(rp_err));
+        co_return YtDlpExit{.exit_code = exit_code,
+                            .std_err = std::move(std_err_of_the_process)};
+    }
+
+    corral::Task<std::expected<Subtitles, std::string>> get_subtitles(
+        auto& ioc, std::string const& link, Config const& cfg,
+        Span const& parent)
+    {
+        Span span = parent.child("get_subtitles");
+        span.annotate(link);
+        if (yt_dlp_workers != nullptr)
             {
-                auto [ec, exit_code]
-                    = co_await p.async_wait(corral::asio_nothrow_awaitable);
-                co_return exit_code;
-            };
+                LOG_INFO(logger,
+                         "Asked a yt-dlp worker for {} with {} language", link,
+                         cfg.language);
+                ScopedTimer timer(metrics.yt_dlp_duration);
+                auto res = co_await yt_dlp_workers->fetch(link, cfg.language);
+                if (not res)
+                    {
+                        co_return std::unexpected(fmt::format(
+                            "Failed to do yt-dlp: {}", res.error()));
+                    }
+                co_return std::move(*res);
+            }
 
         LOG_INFO(logger, "Called yt-dlp for {} with {} language", link,
                  cfg.language);
-        auto [ec_proc, subtitles_received, std_err_of_the_process]
-            = co_await corral::allOf(wait_proc(proc), read_loop(rp),
-                                     read_loop(rp_err));
-
-        if (not std_err_of_the_process.empty() || ec_proc != 0)
+        ScopedTimer timer(metrics.yt_dlp_duration);
+        std::optional<Subtitles> received;
+        auto res = co_await run_yt_dlp(
+            ioc, {link}, cfg,
+            [&received](std::string const&, Subtitles subtitles)
+                { received = std::move(subtitles); });
+        if (not res)
             {
-                co_return std::unexpected(fmt::format(
-                    "Failed to do yt-dlp: ec: {}\nstderr: {}\nstdout: {}",
-                    ec_proc, std_err_of_the_process, subtitles_received));
+                co_return std::unexpected(res.error());
             }
-
-        co_return subtitles_received;
+        if (not received.has_value())
+            {
+                co_return std::unexpected(
+                    fmt::format("Failed to do yt-dlp: ec: {}\nstderr: {}",
+                                res->exit_code, res->std_err));
+            }
+        co_return std::move(*received);
     }
 
-    corral::Task<std::expected<std::string, std::string>> typical_http_request(
-        auto& ioc, std::string const& request_body, const boost::url& url,
-        beast::http::verb method, beast::http::fields headers)
+    corral::Task<std::expected<std::pmr::string, std::string>>
+    typical_http_request(auto& ioc, std::string_view request_body,
+                         const boost::url& url, beast::http::verb method,
+                         beast::http::fields headers, Span const& parent,
+                         std::pmr::memory_resource* memory)
     {
         auto resolver = net::ip::tcp::resolver{ioc};
+        Span stage = parent.child("dns");
 
         LOG_DEBUG(logger,
                   "DNS look-up of an URL... "
@@ -206,6 +533,7 @@ namespace
         auto stream = beast::tcp_stream{ioc};
         stream.expires_after(std::chrono::seconds(HTTP_MAX_TIME_TIMEOUT_RFC));
 
+        stage = parent.child("connect");
         LOG_DEBUG(logger, "Trying to connect to an URL...");
         auto [ec_connect, ep] = co_await stream.async_connect(
             results, corral::asio_nothrow_awaitable);
@@ -220,17 +548,22 @@ namespace
                   "method: {} path: {} http version:{}",
                   magic_enum::enum_name(method),
                   std::string(url.encoded_resource()), HTTP_VERSION_TO_USE);
-        beast::http::request<http::string_body> request{
-            method, url.encoded_resource(), HTTP_VERSION_TO_USE, request_body,
-            headers};
+        beast::http::request<PmrStringBody> request{
+            method, url.encoded_resource(), HTTP_VERSION_TO_USE,
+            std::pmr::string(request_body, memory), headers};
         request.set(beast::http::field::host, url.host());
         request.set(beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
         request.prepare_payload();
-        std::stringstream strs;
-        strs << request;
-        LOG_TRACE_L1(logger, "Request:\n{}", strs.str());
+        LOG_PAYLOAD(TraceL1, "Request",
+                    [&request]
+                        {
+                            std::stringstream strs;
+                            strs << request;
+                            return strs.str();
+                        }());
         stream.expires_after(MAX_PROMPT_TIME);
 
+        stage = parent.child("write_request");
         LOG_INFO(logger, "Sending request to an LLM...");
         auto [ec_write, bytes_written] = co_await beast::http::async_write(
             stream, request, corral::asio_nothrow_awaitable);
@@ -239,10 +572,14 @@ namespace
                 co_return std::unexpected(ec_write.message());
             }
 
-        beast::flat_buffer buffer(MAX_EXPECTED_CHARACTERS);
+        beast::basic_flat_buffer<std::pmr::polymorphic_allocator<char>> buffer(
+            MAX_EXPECTED_CHARACTERS, memory);
 
-        beast::http::response<http::string_body> response;
+        beast::http::response<PmrStringBody> response{
+            std::piecewise_construct,
+            std::make_tuple(std::pmr::polymorphic_allocator<char>(memory))};
 
+        stage = parent.child("read_response");
         LOG_INFO(logger, "Waiting for response...");
         auto [ec_read, bytes_read] = co_await beast::http::async_read(
             stream, buffer, response, corral::asio_nothrow_awaitable);
@@ -252,6 +589,7 @@ namespace
             }
         LOG_INFO(logger, "Received response.");
 
+        stage = parent.child("shutdown");
         LOG_DEBUG(logger, "Trying to close connection.");
 
         beast::error_code error_code;
@@ -269,12 +607,15 @@ namespace
                 co_return std::unexpected("returned with status not 200");
             }
 
-        co_return response.body();
+        co_return std::move(response.body());
     }
 
-    corral::Task<std::expected<std::string, std::string>> typical_https_request(
-        auto& ioc, std::string const& request_body, boost::url const& url,
-        beast::http::verb method, const beast::http::fields& headers)
+    corral::Task<std::expected<std::pmr::string, std::string>>
+    typical_https_request(auto& ioc, std::string_view request_body,
+                          boost::url const& url, beast::http::verb method,
+                          const beast::http::fields& headers,
+                          Span const& parent,
+                          std::pmr::memory_resource* memory)
     {
         net::ssl::context sslCtx(boost::asio::ssl::context::tlsv13);
 
@@ -287,6 +628,7 @@ namespace
         stream.set_verify_callback(
             ssl::host_name_verification(url.host_name()));
 
+        Span stage = parent.child("dns");
         LOG_DEBUG(logger,
                   "DNS look-up of an URL... "
                   "host: {} port:{}",
@@ -312,6 +654,7 @@ namespace
         beast::get_lowest_layer(stream).expires_after(
             std::chrono::seconds(HTTP_MAX_TIME_TIMEOUT_RFC));
 
+        stage = parent.child("connect");
         LOG_DEBUG(logger, "Trying to connect to...");
         auto [ec_connect, ep]
             = co_await beast::get_lowest_layer(stream).async_connect(
@@ -322,6 +665,7 @@ namespace
             }
         LOG_DEBUG(logger, "Successfully.");
 
+        stage = parent.child("tls_handshake");
         LOG_DEBUG(logger, "Trying to do SSL handshake...");
         auto ec_handshake = co_await stream.async_handshake(
             ssl::stream_base::client, corral::asio_nothrow_awaitable);
@@ -336,17 +680,22 @@ namespace
                   "method: {} path: {} http version:{}",
                   magic_enum::enum_name(method),
                   std::string(url.encoded_resource()), HTTP_VERSION_TO_USE);
-        beast::http::request<http::string_body> request{
-            method, url.encoded_resource(), HTTP_VERSION_TO_USE, request_body,
-            headers};
+        beast::http::request<PmrStringBody> request{
+            method, url.encoded_resource(), HTTP_VERSION_TO_USE,
+            std::pmr::string(request_body, memory), headers};
         request.set(beast::http::field::host, url.host());
         request.set(beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
         request.prepare_payload();
-        std::stringstream strs;
-        strs << request;
-        LOG_TRACE_L1(logger, "Request:\n{}", strs.str());
+        LOG_PAYLOAD(TraceL1, "Request",
+                    [&request]
+                        {
+                            std::stringstream strs;
+                            strs << request;
+                            return strs.str();
+                        }());
         beast::get_lowest_layer(stream).expires_after(MAX_PROMPT_TIME);
 
+        stage = parent.child("write_request");
         LOG_INFO(logger, "Sending request to an LLM...");
         auto [ec_write, bytes_written] = co_await beast::http::async_write(
             stream, request, corral::asio_nothrow_awaitable);
@@ -355,10 +704,14 @@ namespace
                 co_return std::unexpected(ec_write.message());
             }
 
-        beast::flat_buffer buffer(MAX_EXPECTED_CHARACTERS);
+        beast::basic_flat_buffer<std::pmr::polymorphic_allocator<char>> buffer(
+            MAX_EXPECTED_CHARACTERS, memory);
 
-        beast::http::response<http::string_body> response;
+        beast::http::response<PmrStringBody> response{
+            std::piecewise_construct,
+            std::make_tuple(std::pmr::polymorphic_allocator<char>(memory))};
 
+        stage = parent.child("read_response");
         LOG_INFO(logger, "Waiting for response...");
         auto [ec_read, bytes_read] = co_await beast::http::async_read(
             stream, buffer, response, corral::asio_nothrow_awaitable);
@@ -368,6 +721,7 @@ namespace
             }
         LOG_INFO(logger, "Received response.");
 
+        stage = parent.child("shutdown");
         LOG_DEBUG(logger, "Trying to close connection.");
 
         auto ec
@@ -385,205 +739,1166 @@ namespace
                 co_return std::unexpected("returned with status not 200");
             }
 
-        co_return response.body();
+        co_return std::move(response.body());
     }
 
-    corral::Task<std::expected<std::string, std::string>> request_to_LLM(
-        auto& ioc, std::string& request_body, Config const& cfg)
+    /// The response is allocated from `memory`.
+    corral::Task<std::expected<std::pmr::string, std::string>> typical_request(
+        auto& ioc, std::string_view request_body, boost::url const& url,
+        beast::http::verb method, beast::http::fields const& headers,
+        Span const& parent,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource())
     {
-        if ("https" == cfg.url.scheme())
+        if ("https" == url.scheme())
             {
+#ifdef YTTO_WITH_NGHTTP2
+                if (http2_pool != nullptr)
+                    {
+                        Span span = parent.child("http2_request");
+                        auto res = co_await http2_pool->request(
+                            method, url, headers, request_body);
+                        if (res.has_value())
+                            {
+                                co_return std::pmr::string(*res, memory);
+                            }
+                        LOG_DEBUG(logger,
+                                  "{} does not speak HTTP/2, using HTTP/1.1",
+                                  std::string(url.host()));
+                    }
+#endif
                 co_return co_await typical_https_request(
-                    ioc, request_body, cfg.url, cfg.method, cfg.headers);
+                    ioc, request_body, url, method, headers, parent, memory);
             }
         else
             {
                 co_return co_await typical_http_request(
-                    ioc, request_body, cfg.url, cfg.method, cfg.headers);
+                    ioc, request_body, url, method, headers, parent, memory);
+            }
+    }
+
+    corral::Task<std::expected<std::pmr::string, std::string>> request_to_LLM(
+        auto& ioc, std::string_view request_body, Config const& cfg,
+        Span const& parent, std::pmr::memory_resource* memory)
+    {
+        Span span = parent.child("request_to_LLM");
+        ScopedTimer timer(metrics.llm_latency);
+        co_return co_await typical_request(ioc, request_body, cfg.url,
+                                           cfg.method, cfg.headers, span,
+                                           memory);
+    }
+
+    /// Runs --response-parser-command with the response on its stdin, its
+    /// stdout is the summary.
+    corral::Task<std::expected<ParsedResponse, std::string>>
+    parse_response_by_command(auto& ioc, std::string_view raw_response,
+                              std::string const& command)
+    {
+        net::writable_pipe wp{ioc};
+        net::readable_pipe rp{ioc};
+        net::readable_pipe rp_err{ioc};
+        boost::process::shell cmd = boost::process::shell(command);
+        auto exe = cmd.exe();
+        auto proc = boost::process::process(
+            ioc, exe, cmd.args(),
+            boost::process::process_stdio{.in = wp, .out = rp, .err = rp_err});
+
+        auto write_response = [&]() -> corral::Task<void>
+            {
+                co_await net::async_write(wp, net::buffer(raw_response),
+                                          corral::asio_nothrow_awaitable);
+                wp.close();
+            };
+
+        auto [written, exit_code, parsed, std_err_of_the_process]
+            = co_await corral::allOf(write_response(), wait_process(proc),
+                                     read_pipe(rp), read_pipe(rp_err));
+
+        if (exit_code != 0)
+            {
+                co_return std::unexpected(
+                    fmt::format("{} exited with {}\nstderr: {}\n{}", command,
+                                exit_code, std_err_of_the_process,
+                                raw_response));
+            }
+        co_return ParsedResponse{.summary = std::move(parsed)};
+    }
+
+    corral::Task<std::expected<ParsedResponse, std::string>> parse_response(
+        auto& ioc, std::string_view raw_response, Config const& cfg)
+    {
+        if (not cfg.response_parser_command.empty())
+            {
+                co_return co_await parse_response_by_command(
+                    ioc, raw_response, cfg.response_parser_command);
+            }
+        try
+            {
+                // Parsers, plugins included, take a std::string.
+                co_return cfg.response_parser->getResponse(
+                    std::string(raw_response));
+            }
+        catch (OmegaException<std::string>& e)
+            {
+                co_return std::unexpected(
+                    fmt::format("{}\n{}", e.what(), e.data()));
+            }
+    }
+
+    /// Sleeps until the deadline, forever if there is none.
+    corral::Task<void> sleep_until(
+        auto& ioc,
+        std::optional<std::chrono::steady_clock::time_point> deadline)
+    {
+        if (not deadline.has_value())
+            {
+                co_await corral::SuspendForever{};
+            }
+        co_await corral::sleepFor(ioc,
+                                  *deadline - std::chrono::steady_clock::now());
+    }
+
+    /// Summarization of an entry of a feed. Shared, since with
+    /// --feed-deadline the task doing it may outlive the feed's request.
+    struct EntryJob
+    {
+        std::string link_str;
+        inja::json data;
+        Span span;
+        std::optional<std::expected<std::string, std::string>> summary;
+        corral::Event done;
+    };
+
+    /// A summary being made, for jobs asking for the same one meanwhile to
+    /// wait for it instead of making it again.
+    struct SummaryInFlight
+    {
+        std::optional<std::expected<std::string, std::string>> summary;
+        corral::Event done;
+    };
+
+    // By summary_key. With --feed-deadline jobs of a feed keep running while
+    // the next poll of the feed asks for the same summaries.
+    std::map<std::string, std::shared_ptr<SummaryInFlight>>
+        summaries_in_flight;
+
+    /// Stores a value in a cache. Backends refuse a key stored meanwhile by
+    /// another job or process with an exception, which like other failures
+    /// to store costs the entry in the cache, not the job.
+    void store(ABCCache& cache, std::string const& key,
+               std::string const& value)
+    {
+        try
+            {
+                cache.set(key, value);
+            }
+        catch (std::exception const& e)
+            {
+                LOG_WARNING(logger, "Failed to store {} in cache: {}", key,
+                            e.what());
+            }
+    }
+
+    /**
+     * Stages of summarization of an entry: fetching of subtitles by yt-dlp
+     * and generation of a summary by an LLM, each with its own limit of
+     * concurrent jobs, connected by a bounded queue.
+     *
+     * An entry takes a slot in the queue before its subtitles are fetched and
+     * gives it back once the LLM takes the subtitles. So when the LLM falls
+     * behind, yt-dlp stops fetching subtitles nobody will read for a while,
+     * and while yt-dlp is paced by YouTube, the LLM still has the queue of
+     * fetched subtitles to work on.
+     *
+     * A reload of the config resizes the limits in place.
+     */
+    struct Pipeline
+    {
+        ResizableSemaphore yt_dlp;
+        ResizableSemaphore llm;
+        ResizableSemaphore queue;
+
+        explicit Pipeline(Config const& cfg)
+            : yt_dlp(cfg.concurrency_yt_dlp), llm(cfg.concurrency_ollama),
+              queue(cfg.pipeline_queue)
+        {
+        }
+
+        void resize(Config const& cfg)
+        {
+            yt_dlp.resize(cfg.concurrency_yt_dlp);
+            llm.resize(cfg.concurrency_ollama);
+            queue.resize(cfg.pipeline_queue);
+        }
+    };
+
+    /// Subtitles of videos of a feed fetched by one yt-dlp, see
+    /// fetch_subtitles_batch.
+    struct SubtitleBatch
+    {
+        struct Slot
+        {
+            std::optional<std::expected<Subtitles, std::string>> subtitles;
+            corral::Event ready;
+        };
+        std::map<std::string, Slot> slots;
+
+        void resolve(std::string const& link,
+                     std::expected<Subtitles, std::string> subtitles)
+        {
+            auto it = slots.find(link);
+            if (it == slots.end() || it->second.subtitles.has_value())
+                {
+                    return;
+                }
+            it->second.subtitles = std::move(subtitles);
+            it->second.ready.trigger();
+        }
+    };
+
+    /**
+     * Fetches subtitles of all videos of `batch` by one yt-dlp under one slot
+     * of yt-dlp, so that a start of yt-dlp is paid once per feed instead of
+     * once per video. Every video is stored in the subtitles' cache and
+     * handed to its entry as soon as yt-dlp is done with it. Videos yt-dlp
+     * failed on fail with its stderr once it exits.
+     */
+    corral::Task<void> fetch_subtitles_batch(auto& ioc, SubtitleBatch& batch,
+                                             ABCCache& cache_subtitles,
+                                             Config const& cfg,
+                                             Pipeline& pipeline, Span span)
+    {
+        span.annotate(fmt::format("{} videos", batch.slots.size()));
+        std::optional<GaugeGuard> waiting(std::in_place,
+                                          metrics.semaphore_yt_dlp.waiting);
+        Span stage = span.child("wait_yt_dlp_slot");
+        auto lock = co_await pipeline.yt_dlp.lock();
+        stage.end();
+        waiting.reset();
+        GaugeGuard in_flight(metrics.semaphore_yt_dlp.in_flight);
+
+        std::vector<std::string> links;
+        links.reserve(batch.slots.size());
+        for (auto& [link, slot] : batch.slots)
+            {
+                links.push_back(link);
+            }
+        LOG_INFO(logger, "Called yt-dlp for {} videos with {} language",
+                 links.size(), cfg.language);
+        ScopedTimer timer(metrics.yt_dlp_duration);
+        auto res = co_await run_yt_dlp(
+            ioc, links, cfg,
+            [&batch, &cache_subtitles](std::string const& link,
+                                       Subtitles subtitles)
+                {
+                    if (subtitles.has_value())
+                        {
+                            LOG_PAYLOAD(TraceL1, "Received subtitles",
+                                        *subtitles);
+                            store(cache_subtitles, link, *subtitles);
+                        }
+                    batch.resolve(link, std::move(subtitles));
+                });
+
+        std::string const error
+            = res ? fmt::format("Failed to do yt-dlp: ec: {}\nstderr: {}",
+                                res->exit_code, res->std_err)
+                  : res.error();
+        for (auto& [link, slot] : batch.slots)
+            {
+                batch.resolve(link, std::unexpected(error));
             }
     }
 
     corral::Task<std::expected<std::string, std::string>> summarize(
-        corral::Semaphore& semaphore_yt_dlp,
-        corral::Semaphore& semaphore_ollama, std::string const& link_str,
-        inja::json& data, auto& ioc, ABCCache& cache, ABCCache& cache_subtitles,
-        Config const& cfg)
+        Pipeline& pipeline, std::string const& link_str, inja::json& data,
+        auto& ioc, ABCCache& cache, ABCCache& cache_subtitles,
+        Config const& cfg, Span const& parent,
+        std::optional<std::chrono::steady_clock::time_point> wait_deadline
+        = std::nullopt,
+        bool allow_stale = true,
+        std::shared_ptr<SubtitleBatch> batch = nullptr,
+        bool known_miss = false,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource())
     {
-        LOG_INFO(logger, "Checking cache...");
-        std::optional<std::string> possible_res = cache.get(link_str);
-        if (possible_res.has_value())
+        Span span = parent.child("summarize");
+        std::string const key = summary_key(link_str, cfg.summary_version);
+        Span stage;
+        // main_logic looks up summaries of a whole feed at once.
+        if (not known_miss)
             {
-                LOG_INFO(logger, "Found result in cache.");
-                co_return *possible_res;
+                LOG_INFO(logger, "Checking cache...");
+                stage = span.child("cache_lookup");
+                std::optional<std::string> possible_res = cache.get(key);
+                if (possible_res.has_value())
+                    {
+                        metrics.cache_summaries.hits.inc();
+                        LOG_INFO(logger, "Found result in cache.");
+                        co_return *possible_res;
+                    }
+                metrics.cache_summaries.misses.inc();
+                LOG_INFO(logger, "Not found in cache.");
             }
         std::string summary;
-        LOG_INFO(logger, "Not found in cache.");
 
+        if (allow_stale && regeneration_queue != nullptr)
+            {
+                for (auto const& version : cfg.stale_summary_versions)
+                    {
+                        std::optional<std::string> stale
+                            = cache.get(summary_key(link_str, version));
+                        if (stale.has_value())
+                            {
+                                LOG_INFO(logger,
+                                         "Found a summary of an older "
+                                         "version in cache. Serving it "
+                                         "until it's regenerated.");
+                                regeneration_queue->push(link_str, data);
+                                co_return *stale;
+                            }
+                    }
+            }
+
+        Job job{.link = link_str,
+                .author = data["author"].get<std::string>(),
+                .title = data["title"].get<std::string>(),
+                .description = data["description"].get<std::string>(),
+                .state = JobState::Pending};
+        auto const record_job = [&job](JobState state)
+            {
+                if (journal != nullptr)
+                    {
+                        job.state = state;
+                        journal->record(job);
+                    }
+            };
+        record_job(JobState::Pending);
+        // Failures of the video itself, not deadlines of the feed, are
+        // backed off.
+        auto const fail = [&](FailureKind kind, std::string error)
+            {
+                metrics.fail(kind);
+                record_job(JobState::Failed);
+                if (failures != nullptr)
+                    {
+                        failures->record(link_str, kind, error);
+                    }
+                return std::unexpected(std::move(error));
+            };
+
+        std::optional<GaugeGuard> backpressured(std::in_place,
+                                                metrics.pipeline.backpressured);
+        stage = span.child("wait_queue_slot");
+        auto [queue_slot, queue_expired] = co_await corral::anyOf(
+            pipeline.queue.lock(), sleep_until(ioc, wait_deadline));
+        stage.end();
+        if (not queue_slot)
+            {
+                co_return std::unexpected(
+                    "Deadline of the feed passed while waiting for room in "
+                    "the queue to the LLM");
+            }
+        backpressured.reset();
+        std::optional<GaugeGuard> queued(std::in_place,
+                                         metrics.pipeline.queued);
+
+        stage = span.child("cache_lookup_subtitles");
         std::optional<std::string> maybe_subtitles
             = cache_subtitles.get(link_str);
+        stage.end();
+        // A video without subtitles in any of --language is remembered, so
+        // that yt-dlp isn't asked for it again until the TTL passes.
+        auto const fail_without_subtitles = [&]()
+            {
+                if (no_subtitles != nullptr)
+                    {
+                        no_subtitles->add(link_str, cfg.language);
+                    }
+                metrics.fail(FailureKind::NoSubtitles);
+                record_job(JobState::Failed);
+                return std::unexpected(fmt::format(
+                    "No subtitles in {} for {}", cfg.language, link_str));
+            };
         std::string subtitles;
         if (maybe_subtitles.has_value())
             {
+                metrics.cache_subtitles.hits.inc();
                 subtitles = *maybe_subtitles;
             }
+        else if (no_subtitles != nullptr
+                 && no_subtitles->contains(link_str, cfg.language))
+            {
+                metrics.cache_subtitles.misses.inc();
+                record_job(JobState::Failed);
+                co_return std::unexpected(fmt::format(
+                    "No subtitles in {} for {} as of the last try",
+                    cfg.language, link_str));
+            }
+        else if (batch != nullptr && batch->slots.contains(link_str))
+            {
+                metrics.cache_subtitles.misses.inc();
+                SubtitleBatch::Slot& slot = batch->slots.at(link_str);
+                stage = span.child("wait_yt_dlp_batch");
+                auto [ready, expired] = co_await corral::anyOf(
+                    slot.ready, sleep_until(ioc, wait_deadline));
+                stage.end();
+                if (not ready)
+                    {
+                        co_return std::unexpected(
+                            "Deadline of the feed passed while waiting for "
+                            "yt-dlp");
+                    }
+                auto const& fetched = *slot.subtitles;
+                if (not fetched)
+                    {
+                        co_return fail(FailureKind::YtDlp, fetched.error());
+                    }
+                if (not fetched->has_value())
+                    {
+                        co_return fail_without_subtitles();
+                    }
+                // Already stored in the subtitles' cache by the batch.
+                LOG_INFO(logger, "Received subtitles from a batch of yt-dlp!");
+                subtitles = **fetched;
+                record_job(JobState::SubtitlesFetched);
+            }
         else
             {
+                metrics.cache_subtitles.misses.inc();
                 std::string subtitles_received;
 
                 {
-                    auto lock = co_await semaphore_yt_dlp.lock();
-                    auto sub_res = co_await get_subtitles(ioc, link_str, cfg);
+                    std::optional<GaugeGuard> waiting(
+                        std::in_place, metrics.semaphore_yt_dlp.waiting);
+                    stage = span.child("wait_yt_dlp_slot");
+                    auto [lock, expired] = co_await corral::anyOf(
+                        pipeline.yt_dlp.lock(), sleep_until(ioc, wait_deadline));
+                    stage.end();
+                    if (not lock)
+                        {
+                            co_return std::unexpected(
+                                "Deadline of the feed passed while waiting "
+                                "for yt-dlp");
+                        }
+                    waiting.reset();
+                    GaugeGuard in_flight(metrics.semaphore_yt_dlp.in_flight);
+                    auto sub_res
+                        = co_await get_subtitles(ioc, link_str, cfg, span);
                     if (!sub_res)
                         {
-                            co_return std::unexpected(sub_res.error());
+                            co_return fail(FailureKind::YtDlp,
+                                           std::move(sub_res.error()));
+                        }
+                    if (not sub_res->has_value())
+                        {
+                            co_return fail_without_subtitles();
                         }
-                    subtitles_received = std::move(*sub_res);
+                    subtitles_received = std::move(**sub_res);
                 }
 
                 LOG_INFO(logger, "Received subtitles!");
-                LOG_TRACE_L1(logger, "Received subtitles: {}",
-                             subtitles_received);
+                LOG_PAYLOAD(TraceL1, "Received subtitles", subtitles_received);
                 subtitles = std::move(subtitles_received);
                 LOG_INFO(logger,
                          "Saving received subtitles to "
                          "subtitles's cache...");
-                cache_subtitles.set(link_str, subtitles);
+                stage = span.child("cache_store_subtitles");
+                store(cache_subtitles, link_str, subtitles);
+                stage.end();
                 LOG_INFO(logger,
                          "Saved received subtitles to "
                          "subtitles's cache.");
+                record_job(JobState::SubtitlesFetched);
             }
 
-        data["subtitles"] = subtitles;
-        std::string prompt = inja::render(cfg.prompt_template, data);
+        stage = span.child("render_prompt");
+        if (not cfg.keep_raw_subtitles)
+            {
+                SubtitleNormalizer normalizer(
+                    {.drop_filler_words = cfg.drop_filler_words});
+                SubtitleNormalizer::Result normalized
+                    = normalizer.normalize(subtitles);
+                LOG_INFO(logger,
+                         "Compacted subtitles of {}: {} -> {} bytes, ~{} -> "
+                         "~{} tokens ({:.1f}% less)",
+                         link_str, normalized.bytes_before,
+                         normalized.bytes_after,
+                         normalized.approx_tokens_before(),
+                         normalized.approx_tokens_after(),
+                         normalized.reduction_percent());
+                subtitles = std::move(normalized.text);
+            }
 
-        inja::json data_prompt;
-        boost::algorithm::replace_all(prompt, "\n", R"(\n)");
-        boost::algorithm::replace_all(prompt, "\"", R"(\")");
-        data_prompt["prompt"] = prompt;
-        std::string request_body
-            = inja::render(cfg.http_body_template, data_prompt);
+        data["subtitles"] = subtitles;
+        std::pmr::string request_body
+            = cfg.request_templates->render(data, memory);
+        stage.end();
 
-        std::string LLM_res;
+        std::pmr::string LLM_res(memory);
 
         {
-            auto lock = co_await semaphore_ollama.lock();
-            auto llm_res = co_await request_to_LLM(ioc, request_body, cfg);
+            std::optional<GaugeGuard> waiting(std::in_place,
+                                              metrics.semaphore_llm.waiting);
+            stage = span.child("wait_llm_slot");
+            std::optional<ScopedTimer> ready_wait(std::in_place,
+                                                  metrics.pipeline.ready_wait);
+            auto [lock, expired] = co_await corral::anyOf(
+                pipeline.llm.lock(), sleep_until(ioc, wait_deadline));
+            stage.end();
+            if (not lock)
+                {
+                    co_return std::unexpected(
+                        "Deadline of the feed passed while waiting for an LLM");
+                }
+            ready_wait.reset();
+            waiting.reset();
+            queued.reset();
+            queue_slot.reset();
+            GaugeGuard in_flight(metrics.semaphore_llm.in_flight);
+            auto llm_res = co_await request_to_LLM(ioc, request_body, cfg,
+                                                   span, memory);
             if (!llm_res)
                 {
-                    co_return std::unexpected(llm_res.error());
+                    co_return fail(FailureKind::LlmRequest,
+                                   std::move(llm_res.error()));
                 }
             LLM_res = std::move(*llm_res);
         }
 
-        OllamaParser parser;
-
-        summary = parser.getResponse(LLM_res);
+        stage = span.child("parse_response");
+        auto parsed = co_await parse_response(ioc, LLM_res, cfg);
+        if (!parsed)
+            {
+                co_return fail(FailureKind::LlmResponseParse,
+                               fmt::format("Failed to parse LLM's response: {}",
+                                           parsed.error()));
+            }
+        summary = std::move(parsed->summary);
+        if (parsed->usage.has_value())
+            {
+                if (parsed->usage->model.empty())
+                    {
+                        parsed->usage->model = cfg.model;
+                    }
+                llm_usage.observe(std::string(cfg.url.encoded_host_and_port()),
+                                  *parsed->usage);
+            }
 
-        LOG_TRACE_L1(logger, "Received response:{}", LLM_res);
+        LOG_PAYLOAD(TraceL1, "Received response", LLM_res);
         LOG_DEBUG(logger, "Saving response to cache");
 
-        cache.set(link_str, summary);
+        stage = span.child("cache_store_summary");
+        store(cache, key, summary);
+        record_job(JobState::Summarized);
+        if (failures != nullptr)
+            {
+                failures->forget(link_str);
+            }
 
         co_return summary;
     }
 
+    /**
+     * Summarizes entries of the feed and appends summaries to descriptions.
+     * With --feed-deadline the entries are summarized in `background`: when
+     * the deadline passes, the feed is returned with summaries ready by then,
+     * entries still waiting for a semaphore give up, and the ones already
+     * running yt-dlp or an LLM finish into the cache, keeping `config` alive
+     * until then. With `cached_only` only summaries in the cache are
+     * appended and nothing is summarized.
+     */
     corral::Task<std::string> main_logic(auto& ioc,
                                          boost::property_tree::ptree tree,
                                          ABCCache& cache,
                                          ABCCache& cache_subtitles,
-                                         Config const& cfg,
-                                         corral::Semaphore& semaphore_yt_dlp,
-                                         corral::Semaphore& semaphore_ollama)
+                                         std::shared_ptr<Config const> config,
+                                         Pipeline& pipeline,
+                                         corral::Nursery& background,
+                                         Span const& parent,
+                                         bool cached_only = false)
     {
-        CORRAL_WITH_NURSERY(nursery)
-        {
-            for (auto& xml_entry : tree.get_child("feed"))
-                {
-                    if ("entry" != xml_entry.first)
-                        {
-                            continue;
-                        }
-                    auto const& link
-                        = xml_entry.second.get_child("link.<xmlattr>.href");
-                    std::string link_str = link.data();
-                    LOG_INFO(logger,
-                             "Got link to a YouTube video, maybe... Here's "
-                             "the link: {}",
-                             link_str);
-                    if (not cfg.proceed_with_shorts
-                        and link_str.contains("shorts"))
-                        {
-                            LOG_INFO(logger,
-                                     "This is a link to a short. Skipping.");
-                            continue;
-                        }
+        Config const& cfg = *config;
+        Span span = parent.child("main_logic");
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        if (cfg.feed_deadline_seconds != 0)
+            {
+                deadline = std::chrono::steady_clock::now()
+                           + std::chrono::seconds(cfg.feed_deadline_seconds);
+            }
+
+        // Bookkeeping of the feed, and requests to the LLM and its responses,
+        // are allocated from an arena in the frame of the coroutine and
+        // released at once with it. With a deadline jobs may outlive the
+        // feed, so then jobs and their requests are allocated on the heap.
+        std::array<std::byte, FEED_ARENA_BYTES> arena_buffer;
+        std::pmr::monotonic_buffer_resource arena(arena_buffer.data(),
+                                                  arena_buffer.size());
+        std::pmr::memory_resource* const job_memory
+            = deadline.has_value() ? std::pmr::new_delete_resource() : &arena;
+        std::pmr::polymorphic_allocator<EntryJob> job_allocator(job_memory);
+
+        std::pmr::vector<std::pair<std::shared_ptr<EntryJob>,
+                                   boost::property_tree::ptree*>>
+            jobs(&arena);
+        for (auto& xml_entry : tree.get_child("feed"))
+            {
+                if ("entry" != xml_entry.first)
+                    {
+                        continue;
+                    }
+                auto const& link
+                    = xml_entry.second.get_child("link.<xmlattr>.href");
+                std::string link_str = link.data();
+                LOG_INFO(logger,
+                         "Got link to a YouTube video, maybe... Here's "
+                         "the link: {}",
+                         link_str);
+                // The link is handed to yt-dlp, so anything but a plain link
+                // to a video is not trusted.
+                static RE2 const video_link_re(
+                    R"(^https:\/\/www\.youtube\.com\/(watch\?v=|shorts\/)[a-zA-Z0-9_-]{11}$)");
+                if (not RE2::FullMatch(link_str, video_link_re))
+                    {
+                        LOG_WARNING(logger,
+                                    "This is not a link to a YouTube video. "
+                                    "Skipping.");
+                        continue;
+                    }
+                if (not cfg.proceed_with_shorts
+                    and link_str.contains("shorts"))
+                    {
+                        LOG_INFO(logger,
+                                 "This is a link to a short. Skipping.");
+                        continue;
+                    }
 
-                    auto const& author
-                        = xml_entry.second.get_child("author.name");
-                    auto const& title
-                        = xml_entry.second.get_child("media:group.media:title");
-                    auto& description = xml_entry.second.get_child(
-                        "media:group.media:description");
+                auto const& author = xml_entry.second.get_child("author.name");
+                auto const& title
+                    = xml_entry.second.get_child("media:group.media:title");
+                auto& description = xml_entry.second.get_child(
+                    "media:group.media:description");
+
+                auto job = std::allocate_shared<EntryJob>(job_allocator);
+                job->link_str = std::move(link_str);
+                job->data["author"] = author.data();
+                job->data["title"] = title.data();
+                job->data["description"] = description.data();
+                job->data["link"] = job->link_str;
+                job->data["published"]
+                    = xml_entry.second.get<std::string>("published", "");
+                job->span = span.child("entry", true);
+                job->span.annotate(job->link_str);
+                jobs.emplace_back(std::move(job), &description);
+            }
 
-                    nursery.start(
-                        [&, link_str = link_str, author = std::cref(author),
-                         title = std::cref(title),
-                         description = std::ref(
-                             description)]() mutable -> corral::Task<void>
+        // Entries with cached summaries are filled in right away, without
+        // spawning tasks for them.
+        // Keys and views of them live in the arena: the vector's allocator
+        // is handed to the strings it constructs.
+        std::pmr::vector<std::pmr::string> keys(&arena);
+        std::pmr::vector<std::string_view> key_views(&arena);
+        keys.reserve(jobs.size());
+        key_views.reserve(jobs.size());
+        for (auto& [job, description] : jobs)
+            {
+                key_views.push_back(keys.emplace_back(summary_key(
+                    job->link_str, cfg.summary_version, &arena)));
+            }
+        Span lookup = span.child("cache_lookup_many");
+        std::vector<std::optional<std::string>> cached
+            = cache.get_many(key_views);
+        lookup.end();
+        for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                if (not cached[i].has_value())
+                    {
+                        metrics.cache_summaries.misses.inc();
+                        continue;
+                    }
+                metrics.cache_summaries.hits.inc();
+                EntryJob& job = *jobs[i].first;
+                job.summary = std::move(*cached[i]);
+                job.span.end();
+                job.done.trigger();
+            }
+        LOG_INFO(logger, "Found {} of {} summaries in cache.",
+                 std::ranges::count_if(cached,
+                                       [](auto const& summary)
+                                           { return summary.has_value(); }),
+                 jobs.size());
+
+        if (cached_only)
+            {
+                for (auto& [job, description] : jobs)
+                    {
+                        if (not job->summary.has_value())
                             {
-                                inja::json data;
-                                data["author"] = author.get().data();
-                                data["title"] = title.get().data();
-                                data["description"] = description.get().data();
-                                data["link"] = link_str;
-                                auto summary_res = co_await summarize(
-                                    semaphore_yt_dlp, semaphore_ollama,
-                                    link_str, data, ioc, cache, cache_subtitles,
-                                    cfg);
+                                job->summary = std::unexpected(
+                                    "The server is overloaded, only cached "
+                                    "summaries are served");
+                                job->span.end();
+                                job->done.trigger();
+                            }
+                    }
+            }
 
-                                if (!summary_res)
+        // Videos that failed recently are not tried again until their
+        // backoff passes.
+        if (failures != nullptr)
+            {
+                auto const now = std::chrono::duration_cast<
+                                     std::chrono::seconds>(
+                                     std::chrono::system_clock::now()
+                                         .time_since_epoch())
+                                     .count();
+                for (auto& [job, description] : jobs)
+                    {
+                        if (job->summary.has_value())
+                            {
+                                continue;
+                            }
+                        std::optional<FailureCache::Failure> failure
+                            = failures->backed_off(job->link_str);
+                        if (not failure.has_value())
+                            {
+                                continue;
+                            }
+                        metrics.retries_backed_off.inc();
+                        job->summary = std::unexpected(fmt::format(
+                            "Failed {} times in a row ({}), not trying again "
+                            "for {}s. Last error: {}",
+                            failure->attempts, failure->kind,
+                            failure->retry_at - now, failure->error));
+                        job->span.end();
+                        job->done.trigger();
+                    }
+            }
+
+        // With --yt-dlp-batch, subtitles missing in the cache are fetched by
+        // one yt-dlp for the whole feed.
+        std::shared_ptr<SubtitleBatch> batch;
+        if (cfg.yt_dlp_batch)
+            {
+                // Views of links of the jobs, which outlive the lookup.
+                std::pmr::vector<std::string const*> links(&arena);
+                std::pmr::vector<std::string_view> link_views(&arena);
+                for (auto& [job, description] : jobs)
+                    {
+                        if (not job->summary.has_value())
+                            {
+                                links.push_back(&job->link_str);
+                                link_views.push_back(job->link_str);
+                            }
+                    }
+                std::vector<std::optional<std::string>> cached_subtitles
+                    = cache_subtitles.get_many(link_views);
+                for (size_t i = 0; i < links.size(); ++i)
+                    {
+                        if (not cached_subtitles[i].has_value()
+                            && (no_subtitles == nullptr
+                                || not no_subtitles->contains(*links[i],
+                                                              cfg.language)))
+                            {
+                                if (batch == nullptr)
                                     {
-                                        LOG_INFO(logger,
-                                                 "Failed to summarize: {}",
-                                                 summary_res.error());
-                                        co_return;
+                                        batch
+                                            = std::make_shared<SubtitleBatch>();
                                     }
+                                batch->slots.try_emplace(*links[i]);
+                            }
+                    }
+            }
 
-                                LOG_INFO(logger,
-                                         "Appending LLM's result to "
-                                         "entry's description...");
-                                std::string new_description = fmt::format(
-                                    "{}\n\nLLM's result:\n{}",
-                                    description.get().data(), *summary_res);
-                                description.get().put("", new_description);
-                                LOG_INFO(logger,
-                                         "Successfully appended, I guess...");
-                            });
-                }
-            co_return corral::join;
-        };
-        LOG_INFO(logger, "Writing result to stdout...");
-        std::stringstream strs;
-        boost::property_tree::write_xml(strs, tree);
-        LOG_INFO(logger, "Wrote result to stdout.");
-        co_return strs.str();
-    }
-
-    boost::property_tree::ptree parse_rss_into_tree(std::string const& rss_feed)
-    {
-        LOG_DEBUG(logger, "Received something from stdin...");
-        LOG_TRACE_L1(logger, "rss_feed: {}", rss_feed);
-        boost::property_tree::ptree tree;
-        std::istringstream istr(rss_feed);
+        auto const run_job = [&ioc, &cache, &cache_subtitles, config, &pipeline,
+                              deadline, batch,
+                              job_memory](std::shared_ptr<EntryJob> job)
+            -> corral::Task<void>
+            {
+                GaugeGuard pending(metrics.admission.jobs);
+                std::string const key
+                    = summary_key(job->link_str, config->summary_version);
+                if (auto it = summaries_in_flight.find(key);
+                    it != summaries_in_flight.end())
+                    {
+                        LOG_INFO(logger,
+                                 "The summary is already being made. Waiting "
+                                 "for it.");
+                        std::shared_ptr<SummaryInFlight> flight = it->second;
+                        co_await flight->done;
+                        if (flight->summary.has_value())
+                            {
+                                job->summary = *flight->summary;
+                            }
+                        else
+                            {
+                                job->summary = std::unexpected(
+                                    "The job making the summary was "
+                                    "cancelled");
+                            }
+                    }
+                else
+                    {
+                        auto flight = std::make_shared<SummaryInFlight>();
+                        summaries_in_flight.emplace(key, flight);
+                        // Waiters are released even if this job is cancelled.
+                        struct Land
+                        {
+                            std::string const& key;
+                            SummaryInFlight& flight;
+                            ~Land()
+                            {
+                                summaries_in_flight.erase(key);
+                                flight.done.trigger();
+                            }
+                        } land{key, *flight};
+                        job->summary = co_await summarize(
+                            pipeline, job->link_str, job->data, ioc, cache,
+                            cache_subtitles, *config, job->span, deadline,
+                            true, batch, true, job_memory);
+                        flight->summary = job->summary;
+                    }
+                job->span.end();
+                job->done.trigger();
+            };
+        auto const run_batch = [&ioc, &cache_subtitles, config,
+                                &pipeline](std::shared_ptr<SubtitleBatch> batch,
+                                           Span batch_span)
+            -> corral::Task<void>
+            {
+                co_await fetch_subtitles_batch(ioc, *batch, cache_subtitles,
+                                               *config, pipeline,
+                                               std::move(batch_span));
+            };
+
+        if (deadline.has_value())
+            {
+                if (batch != nullptr)
+                    {
+                        background.start(
+                            run_batch, batch,
+                            span.child("get_subtitles_batch", true));
+                    }
+                for (auto& [job, description] : jobs)
+                    {
+                        if (not job->summary.has_value())
+                            {
+                                background.start(run_job, job);
+                            }
+                    }
+                auto const all_done = [&jobs]() -> corral::Task<void>
+                    {
+                        for (auto& [job, description] : jobs)
+                            {
+                                co_await job->done;
+                            }
+                    };
+                auto [done, expired] = co_await corral::anyOf(
+                    all_done(), corral::sleepFor(ioc, *deadline
+                                                          - std::chrono::
+                                                              steady_clock::
+                                                                  now()));
+                if (not done)
+                    {
+                        LOG_INFO(logger,
+                                 "Deadline of the feed passed. Returning it "
+                                 "with summaries ready by now.");
+                    }
+            }
+        else
+            {
+                CORRAL_WITH_NURSERY(nursery)
+                {
+                    if (batch != nullptr)
+                        {
+                            nursery.start(
+                                run_batch, batch,
+                                span.child("get_subtitles_batch", true));
+                        }
+                    for (auto& [job, description] : jobs)
+                        {
+                            if (not job->summary.has_value())
+                                {
+                                    nursery.start(run_job, job);
+                                }
+                        }
+                    co_return corral::join;
+                };
+            }
+
+        for (auto& [job, description] : jobs)
+            {
+                if (not job->summary.has_value())
+                    {
+                        continue;
+                    }
+                auto const& summary_res = *job->summary;
+                if (!summary_res)
+                    {
+                        LOG_INFO(logger, "Failed to summarize: {}",
+                                 summary_res.error());
+                        continue;
+                    }
+
+                LOG_INFO(logger,
+                         "Appending LLM's result to "
+                         "entry's description...");
+                std::string new_description
+                    = fmt::format("{}\n\nLLM's result:\n{}",
+                                  description->data(), *summary_res);
+                description->put("", new_description);
+                LOG_INFO(logger, "Successfully appended, I guess...");
+            }
+
+        LOG_INFO(logger, "Writing result to stdout...");
+        Span stage = span.child("write_xml");
+        std::string res = write_feed(tree);
+        LOG_INFO(logger, "Wrote result to stdout.");
+        co_return res;
+    }
+
+    /// Finishes jobs of the journal left by a previous run. Summaries land in
+    /// the cache, so the feeds of them are served from it afterwards.
+    corral::Task<void> resume_jobs(auto& ioc, ABCCache& cache,
+                                   ABCCache& cache_subtitles, Config const& cfg,
+                                   Pipeline& pipeline)
+    {
+        if (journal == nullptr)
+            {
+                co_return;
+            }
+        std::vector<Job> jobs = journal->outstanding();
+        if (jobs.empty())
+            {
+                co_return;
+            }
+        LOG_INFO(logger, "Resuming {} unfinished jobs from the journal...",
+                 jobs.size());
+        Span span = Span::root(tracer, "resume_jobs");
+        CORRAL_WITH_NURSERY(nursery)
+        {
+            for (Job& job : jobs)
+                {
+                    nursery.start(
+                        [&, job = std::move(job)]() -> corral::Task<void>
+                            {
+                                Span entry_span = span.child("entry", true);
+                                entry_span.annotate(job.link);
+                                inja::json data;
+                                data["author"] = job.author;
+                                data["title"] = job.title;
+                                data["description"] = job.description;
+                                data["link"] = job.link;
+                                auto summary_res = co_await summarize(
+                                    pipeline, job.link, data, ioc, cache,
+                                    cache_subtitles, cfg, entry_span);
+                                if (!summary_res)
+                                    {
+                                        LOG_INFO(logger,
+                                                 "Failed to resume {}: {}",
+                                                 job.link, summary_res.error());
+                                        co_return;
+                                    }
+                                // The summary may have been cached already, in
+                                // which case summarize() doesn't touch the
+                                // journal.
+                                journal->record(
+                                    Job{.link = job.link,
+                                        .author = {},
+                                        .title = {},
+                                        .description = {},
+                                        .state = JobState::Summarized});
+                            });
+                }
+            co_return corral::join;
+        };
+        LOG_INFO(logger, "Resumed jobs are done.");
+    }
+
+    /**
+     * Summarizes again entries served with a summary of an older version, at
+     * most --regenerate-jobs at once, so that a change of the prompt or of the
+     * model doesn't hit the LLM with the whole cache at once. With
+     * `until_empty` returns once the queue is empty, otherwise waits for more.
+     */
+    corral::Task<void> regenerate_stale(auto& ioc, ABCCache& cache,
+                                        ABCCache& cache_subtitles,
+                                        Config const& cfg, Pipeline& pipeline,
+                                        bool until_empty)
+    {
+        if (regeneration_queue == nullptr)
+            {
+                co_return;
+            }
+        CORRAL_WITH_NURSERY(nursery)
+        {
+            for (size_t i = 0; i < cfg.regenerate_jobs; ++i)
+                {
+                    nursery.start(
+                        [&]() -> corral::Task<void>
+                            {
+                                while (true)
+                                    {
+                                        std::optional<inja::json> data
+                                            = regeneration_queue->pop();
+                                        if (not data.has_value())
+                                            {
+                                                if (until_empty)
+                                                    {
+                                                        co_return;
+                                                    }
+                                                co_await corral::sleepFor(
+                                                    ioc,
+                                                    REGENERATION_POLL_INTERVAL);
+                                                continue;
+                                            }
+                                        std::string link
+                                            = (*data)["link"].get<std::string>();
+                                        LOG_INFO(logger,
+                                                 "Regenerating summary of {}. "
+                                                 "Left in queue: {}",
+                                                 link,
+                                                 regeneration_queue->size());
+                                        Span span
+                                            = Span::root(tracer, "regenerate");
+                                        span.annotate(link);
+                                        // A reload may have changed the
+                                        // prompt since the summary was queued.
+                                        std::shared_ptr<Config const> config
+                                            = current_config;
+                                        auto res = co_await summarize(
+                                            pipeline, link, *data, ioc, cache,
+                                            cache_subtitles, *config, span,
+                                            std::nullopt, false);
+                                        if (!res)
+                                            {
+                                                LOG_INFO(logger,
+                                                         "Failed to regenerate "
+                                                         "{}: {}",
+                                                         link, res.error());
+                                            }
+                                        regeneration_queue->done(link);
+                                    }
+                            });
+                }
+            co_return corral::join;
+        };
+    }
+
+    /// Runs steps of the janitor, yielding to the event loop between them.
+    corral::Task<void> clean_cache(auto& ioc, CacheJanitor& janitor,
+                                   CacheMetrics& cache_metrics)
+    {
+        if (not janitor.enabled())
+            {
+                co_await corral::SuspendForever{};
+            }
+        while (true)
+            {
+                CacheJanitor::Step step = janitor.step();
+                cache_metrics.evicted_bytes.inc(step.evicted_bytes);
+                cache_metrics.evicted_files.inc(step.evicted_files);
+                if (step.stored_bytes.has_value())
+                    {
+                        cache_metrics.stored_bytes.set(
+                            static_cast<std::int64_t>(*step.stored_bytes));
+                    }
+                if (step.evicted_files != 0)
+                    {
+                        LOG_DEBUG(logger, "Evicted {} entries, {} bytes",
+                                  step.evicted_files, step.evicted_bytes);
+                    }
+                co_await corral::sleepFor(ioc, janitor.pass_done()
+                                                   ? CACHE_JANITOR_PASS_INTERVAL
+                                                   : CACHE_JANITOR_STEP_INTERVAL);
+            }
+    }
+
+    /// Serves connections of --http2, if any.
+    corral::Task<void> http2_connections()
+    {
+#ifdef YTTO_WITH_NGHTTP2
+        if (http2_pool != nullptr)
+            {
+                co_await http2_pool->run();
+            }
+#endif
+        co_await corral::SuspendForever{};
+    }
+
+    void log_llm_usage()
+    {
+        llm_usage.for_each(
+            [](std::string const& backend, std::string const& model,
+               LlmUsageMetrics::Series const& series)
+                {
+                    std::uint64_t const requests = series.requests.value();
+                    LOG_INFO(logger,
+                             "LLM usage of {} at {}: {} requests, prefill {:.1f} "
+                             "tok/s, decode {:.1f} tok/s, {:.1f} prompt tokens "
+                             "on average, {} load stalls, {:.1f} s loading",
+                             model, backend, requests,
+                             series.prefill_tokens_per_second(),
+                             series.decode_tokens_per_second(),
+                             requests == 0
+                                 ? 0.
+                                 : static_cast<double>(
+                                       series.prompt_tokens.value())
+                                       / static_cast<double>(requests),
+                             series.load_stalls.value(),
+                             static_cast<double>(series.load_ns.value()) / 1e9);
+                });
+    }
+
+    /// Logs a summary of LLM usage every --llm-usage-log-interval, if there
+    /// were requests since the last one.
+    corral::Task<void> llm_usage_reporter(auto& ioc, Config const& cfg)
+    {
+        if (cfg.llm_usage_log_interval_seconds == 0)
+            {
+                co_await corral::SuspendForever{};
+            }
+        std::uint64_t logged_requests = 0;
+        while (true)
+            {
+                co_await corral::sleepFor(
+                    ioc,
+                    std::chrono::seconds(cfg.llm_usage_log_interval_seconds));
+                std::uint64_t requests = 0;
+                llm_usage.for_each(
+                    [&](std::string const&, std::string const&,
+                        LlmUsageMetrics::Series const& series)
+                        { requests += series.requests.value(); });
+                if (requests != logged_requests)
+                    {
+                        logged_requests = requests;
+                        log_llm_usage();
+                    }
+            }
+    }
+
+    corral::Task<void> journal_flusher(auto& ioc)
+    {
+        if (journal == nullptr)
+            {
+                co_await corral::SuspendForever{};
+            }
+        while (true)
+            {
+                co_await corral::sleepFor(ioc, JOURNAL_FLUSH_INTERVAL);
+                journal->flush();
+            }
+    }
+
+    boost::property_tree::ptree parse_rss_into_tree(std::string_view rss_feed)
+    {
+        LOG_DEBUG(logger, "Received something from stdin...");
+        LOG_PAYLOAD(TraceL1, "rss_feed", rss_feed);
         LOG_DEBUG(logger, "Trying to parse it as an XML...");
-        boost::property_tree::read_xml(istr, tree);
+        boost::property_tree::ptree tree = parse_feed(rss_feed);
         LOG_DEBUG(logger, "Successfully parsed an XML...");
         return tree;
     }
 
-    corral::Task<void> async_main_no_server(auto& ioc, ABCCache& cache,
-                                            ABCCache& cache_subtitles,
-                                            Config const& cfg)
+    std::string read_feed_from_stdin()
     {
         LOG_DEBUG(logger, "Waiting for YouTube's RSS feed from stdin...");
         std::cin >> std::noskipws;
@@ -591,23 +1906,726 @@ namespace
         std::istreambuf_iterator<char> end;
         std::string xml_rss_youtube_feed(start, end);
         LOG_DEBUG(logger, "Received the YouTube's RSS feed.");
+        return xml_rss_youtube_feed;
+    }
 
+    corral::Task<void> async_main_no_server(
+        auto& ioc, std::string const& xml_rss_youtube_feed, ABCCache& cache,
+        ABCCache& cache_subtitles, Config const& cfg)
+    {
+        Span span = Span::root(tracer, "stdin_feed");
+        Span stage = span.child("parse_feed");
         boost::property_tree::ptree tree
             = parse_rss_into_tree(xml_rss_youtube_feed);
+        stage.end();
+
+        Pipeline pipeline(cfg);
+        CORRAL_WITH_NURSERY(nursery)
+        {
+            std::string res
+                = co_await main_logic(ioc, tree, cache, cache_subtitles,
+                                      current_config, pipeline, nursery, span);
+            fmt::println("{}", res);
+            std::fflush(stdout);
+            // A reader waiting for EOF gets it now rather than once the jobs
+            // past --feed-deadline and the ones below are done. /dev/null
+            // takes the place of stdout so that nothing else gets fd 1.
+            if (int const null_fd = ::open("/dev/null", O_WRONLY);
+                null_fd != -1)
+                {
+                    ::dup2(null_fd, STDOUT_FILENO);
+                    ::close(null_fd);
+                }
+            // Jobs of an earlier run wait for the feed the user waits on, so
+            // they don't take its slots of yt-dlp and the LLM.
+            nursery.start(
+                [&]
+                    {
+                        return resume_jobs(ioc, cache, cache_subtitles, cfg,
+                                           pipeline);
+                    });
+            // A one-shot run, e.g. from cron, doesn't pay for regeneration
+            // unless asked to.
+            if (cfg.regenerate_stale)
+                {
+                    co_await regenerate_stale(ioc, cache, cache_subtitles, cfg,
+                                              pipeline, true);
+                }
+            co_return corral::join;
+        };
+    }
+
+    /// nullptr for an unknown --response-format.
+    std::shared_ptr<ABCResponseParser const> make_response_parser(
+        std::string_view format)
+    {
+        if (format == "ollama-chat")
+            {
+                return std::make_shared<OllamaChatParser>();
+            }
+        if (format == "ollama-generate")
+            {
+                return std::make_shared<OllamaGenerateParser>();
+            }
+        if (format == "openai-chat")
+            {
+                return std::make_shared<OpenAIChatParser>();
+            }
+        if (format == "gemini")
+            {
+                return std::make_shared<GeminiParser>();
+            }
+        return nullptr;
+    }
+
+    /**
+     * Parses the command line, with options of --config, into a Config.
+     * Returns what main() should return instead, e.g. for --help or for an
+     * invalid option, once `app.exit` printed why to `out` or `err`.
+     */
+    std::expected<Config, int> parse_config(int argc,
+                                            char const* const* argv,
+                                            std::ostream& out,
+                                            std::ostream& err)
+    {
+        Config cfg;
+
+        CLI::App app{
+            "Post-processor for YouTube's RSS feed, so that you get "
+            "summary of video inside the feed via sending an HTTP "
+            "request to something like an Ollama instance."};
+
+        // Temporary storage for CLI11 to map types it doesn't handle natively
+        // without custom validators
+        std::string url_str = "http://127.0.0.1:11434/api/chat";
+        std::string method_str = "post";
+        std::vector<std::string> headers_raw
+            = {"Content-Type: application/json"};
+        std::string log_level_str = "info";
+
+        app.add_option("-c,--cache-folder", cfg.cache_file,
+                       "Folder, in which there will be files as cache of "
+                       "result of summarization")
+            ->required();
+
+        app.add_option("-S,--cache-folder-subtitles", cfg.cache_subtitles_file,
+                       "Folder, in which there will be files as subtitles of a "
+                       "specific YouTube link.")
+            ->required();
+
+        app.add_option("-L,--language", cfg.language,
+                       "Languages of subtitles for yt-dlp, comma-separated, "
+                       "the most preferred first, e.g. en,de or en.*,uk. "
+                       "Subtitles in the first available one are summarized")
+            ->capture_default_str()
+            ->default_val("en");
+
+        app.add_option(
+               "-u,--url", url_str,
+               "URL of ?Ollama? instance in format "
+               "http://127.0.0.1:11434/api/chat")
+            ->capture_default_str();
+
+        app.add_option("-X,--method", method_str,
+                       "HTTP method by which to ask an ?Ollama? instance. "
+                       "Possible values: get, post, head, patch, purge etc.")
+            ->capture_default_str();
+
+        app.add_option("-T,--template", cfg.http_body_template,
+                       "Jinja template for HTTP request to an ?Ollama? "
+                       "instance.")
+            ->default_val(std::string(DEFAULT_HTTP_BODY_TEMPLATE));
+
+        app.add_option("-P,--prompt", cfg.prompt_template,
+                       "Prompt's Jinja template for an LLM")
+            ->default_val(std::string(DEFAULT_PROMPT_TEMPLATE));
+
+        app.add_option("-H,--header", headers_raw,
+                       "HTTP headers for request to an ?Ollama? instance.")
+            ->take_all();
+
+        std::string response_format_str = "ollama-chat";
+        std::filesystem::path response_parser_plugin;
+
+        app.add_option("--response-format", response_format_str,
+                       "Schema of responses of the LLM: ollama-chat, "
+                       "ollama-generate, openai-chat or gemini")
+            ->capture_default_str();
+
+        auto* response_parser_command_opt = app.add_option(
+            "--response-parser-command", cfg.response_parser_command,
+            "Shell command that gets a response of the LLM on stdin and prints "
+            "the summary. Replaces --response-format");
+
+        app.add_option("--response-parser-plugin", response_parser_plugin,
+                       "Shared library that exports a parser of responses of "
+                       "the LLM via Boost::DLL. Replaces --response-format")
+            ->excludes(response_parser_command_opt);
+
+        app.add_option("-l,--log-file", cfg.log_file,
+                       "Filepath to internal logs")
+            ->default_val("./logs.log");
+
+        app.add_option(
+               "--log-level", log_level_str,
+               "Log level: "
+               "tracel3,tracel2,tracel1,debug,info,notice,warning,error,"
+               "critical")
+            ->default_val("info");
+
+        size_t log_payload_limit = PayloadLog::LIMIT_DEFAULT;
+        size_t log_payload_sample = 1;
+
+        app.add_option("--log-payload-limit", log_payload_limit,
+                       "Bytes of subtitles, requests and responses logged at "
+                       "tracel1. 0 means whole ones.")
+            ->capture_default_str();
+
+        app.add_option("--log-payload-sample", log_payload_sample,
+                       "Log only every Nth of subtitles, requests and "
+                       "responses at tracel1")
+            ->check(CLI::PositiveNumber)
+            ->capture_default_str();
+
+        std::string otlp_url_str;
+        std::string feed_source_str
+            = "https://www.youtube.com/feeds/videos.xml";
+
+        app.add_option("--feed-source", feed_source_str,
+                       "Where the server fetches requested feeds from. "
+                       "`?channel_id=` of a request is appended. Useful for "
+                       "mirrors and offline benchmarks.")
+            ->capture_default_str();
+
+        app.add_option("--trace-file", cfg.trace_file,
+                       "Write spans of processing of feeds to this file in "
+                       "Chrome trace JSON format (chrome://tracing, "
+                       "ui.perfetto.dev)");
+
+        app.add_option("--otlp-endpoint", otlp_url_str,
+                       "Export spans as OTLP/HTTP JSON to a collector, e.g. "
+                       "http://127.0.0.1:4318/v1/traces");
+
+        app.add_option("--trace-buffer-spans", cfg.trace_buffer_spans,
+                       "Amount of last spans kept for --trace-file")
+            ->check(CLI::PositiveNumber)
+            ->default_val(TRACE_BUFFER_SPANS_DEFAULT);
+
+        app.add_option("--trace-export-interval",
+                       cfg.trace_export_interval_seconds,
+                       "Seconds between exports of spans")
+            ->check(CLI::PositiveNumber)
+            ->default_val(TRACE_EXPORT_INTERVAL_SECONDS_DEFAULT);
+
+        app.add_option("--feed-deadline", cfg.feed_deadline_seconds,
+                       "Seconds to process a feed in. Then the feed is "
+                       "returned with summaries ready by then, and summaries "
+                       "being made finish into the cache in background. In "
+                       "stdin mode stdout is closed after the feed while the "
+                       "process finishes them. 0 means no deadline.")
+            ->capture_default_str();
+
+        app.add_option("--llm-usage-log-interval",
+                       cfg.llm_usage_log_interval_seconds,
+                       "Seconds between summaries of tokens per second and "
+                       "model loads of the LLM in logs. 0 disables them.")
+            ->default_val(LLM_USAGE_LOG_INTERVAL_SECONDS_DEFAULT);
+
+        std::string cache_backend_str = "files";
+
+        app.add_option("--cache-backend", cache_backend_str,
+                       "How caches are stored: files (a file per entry) or "
+                       "lmdb (an LMDB database per cache folder, if built with "
+                       "it)")
+            ->capture_default_str();
+
+        app.add_option("--lmdb-map-size", cfg.lmdb_map_size,
+                       "Maximum size of an LMDB database, e.g. 16GB. Only "
+                       "address space is reserved.")
+            ->transform(CLI::AsSizeValue(false))
+            ->default_val(LMDB_MAP_SIZE_DEFAULT);
+
+        std::string cache_eviction_str = "lru";
+        size_t cache_ttl_days = 0;
+        size_t cache_subtitles_ttl_days = 0;
+
+        app.add_option("--cache-max-size", cfg.cache_janitor.max_bytes,
+                       "Size limit of --cache-folder, e.g. 500MB. 0 means "
+                       "none.")
+            ->transform(CLI::AsSizeValue(false))
+            ->default_val(0);
+
+        app.add_option("--cache-subtitles-max-size",
+                       cfg.cache_subtitles_janitor.max_bytes,
+                       "Size limit of --cache-folder-subtitles, e.g. 2GB. 0 "
+                       "means none.")
+            ->transform(CLI::AsSizeValue(false))
+            ->default_val(0);
+
+        app.add_option("--cache-ttl-days", cache_ttl_days,
+                       "Remove summaries older than that. 0 means never.")
+            ->capture_default_str();
+
+        app.add_option("--cache-subtitles-ttl-days", cache_subtitles_ttl_days,
+                       "Remove subtitles older than that. 0 means never.")
+            ->capture_default_str();
+
+        app.add_option("--no-subtitles-ttl-hours", cfg.no_subtitles_ttl_hours,
+                       "Don't ask yt-dlp again for that long for a video that "
+                       "had no subtitles in any of --language. 0 means always "
+                       "ask")
+            ->default_val(NO_SUBTITLES_TTL_HOURS_DEFAULT);
+
+        size_t retry_backoff_minutes = 0;
+        size_t retry_backoff_max_hours = 0;
+
+        app.add_option("--retry-backoff-minutes", retry_backoff_minutes,
+                       "Don't try a video that failed again for that long, "
+                       "doubled on every failure in a row. 0 means try on "
+                       "every request")
+            ->default_val(RETRY_BACKOFF_MINUTES_DEFAULT);
+
+        app.add_option("--retry-backoff-max-hours", retry_backoff_max_hours,
+                       "Limit of --retry-backoff-minutes after many failures")
+            ->check(CLI::PositiveNumber)
+            ->default_val(RETRY_BACKOFF_MAX_HOURS_DEFAULT);
+
+        app.add_option("--cache-eviction", cache_eviction_str,
+                       "What to remove first once a cache is over its size "
+                       "limit: lru (least recently used) or oldest (least "
+                       "recently made). Age for TTLs is counted the same way.")
+            ->capture_default_str();
+
+        app.add_option("--regenerate-jobs", cfg.regenerate_jobs,
+                       "Summaries are cached per prompt and model. Once either "
+                       "changes, summaries made with the old ones are served "
+                       "while at most this amount of them is regenerated at "
+                       "once. 0 means regenerating on request instead.")
+            ->capture_default_str()
+            ->default_val(REGENERATE_JOBS_DEFAULT);
+
+        app.add_flag("--regenerate-stale", cfg.regenerate_stale,
+                     "In stdin mode, regenerate summaries of old prompts or "
+                     "models served in the feed after printing it. Otherwise "
+                     "only a server regenerates them.");
+
+        app.add_option("--job-journal", cfg.job_journal_file,
+                       "File to journal jobs to. Jobs interrupted by a restart "
+                       "are resumed from it on the next start.");
+
+        app.add_option("--daemon-socket", cfg.daemon_socket,
+                       "Unix domain socket of a server. With -A the server "
+                       "listens on it too. Without -A a feed from stdin is "
+                       "forwarded to the server if one listens, otherwise it "
+                       "is processed by this process.");
+
+        app.add_flag("-s,--proceed-shorts", cfg.proceed_with_shorts,
+                     "Try do with shorts");
+
+        app.add_flag("--keep-raw-subtitles", cfg.keep_raw_subtitles,
+                     "Do not collapse repeated lines of rolling captions and "
+                     "do not squeeze whitespace in subtitles before prompting");
+
+        app.add_flag("--drop-filler-words", cfg.drop_filler_words,
+                     "Drop filler tokens like \"um\", \"uh\", \"[Music]\" "
+                     "from subtitles before prompting");
+
+        app.add_flag("--http2", cfg.http2,
+                     "Multiplex HTTPS requests over one HTTP/2 connection per "
+                     "host. Hosts that don't negotiate HTTP/2 get HTTP/1.1");
+
+        app.add_flag("-A,--enable-server", cfg.enable_server, "Enable server")
+            ->default_val(false);
+        app.add_flag("-p,--port", cfg.server_port, "Server's port")
+            ->check(CLI::PositiveNumber)
+            ->default_val(SERVER_DEFAULT_PORT);
+
+        app.add_option(
+               "-j,--jobs-yt-tlp", cfg.concurrency_yt_dlp,
+               "Amount of concurrent yt-dlp processes created by this "
+               "application. With --yt-dlp-worker, the size of the pool")
+            ->check(CLI::PositiveNumber)
+            ->default_val(MAX_CONCURRENT_YTDLP_DEFAULT);
+
+        app.add_option("--yt-dlp-worker", cfg.yt_dlp_worker,
+                       "Command of a long-lived yt-dlp, e.g. "
+                       "ytto_yt_dlp_worker.py. A pool of them fetches "
+                       "subtitles instead of a new yt-dlp per video");
+
+        app.add_option("--yt-dlp-worker-jobs", cfg.yt_dlp_worker_jobs,
+                       "Videos after which a worker of --yt-dlp-worker is "
+                       "replaced by a fresh one. 0 means never")
+            ->default_val(YT_DLP_WORKER_JOBS_DEFAULT);
+
+        app.add_flag("--yt-dlp-batch", cfg.yt_dlp_batch,
+                     "Fetch subtitles missing in the cache for all videos of a "
+                     "feed by one yt-dlp instead of one per video")
+            ->excludes("--yt-dlp-worker");
+
+        app.add_option("-J,--jobs-requests", cfg.concurrency_ollama,
+                       "Amount of concurrent request to an ?Ollama? instance "
+                       "sent by this application")
+            ->check(CLI::PositiveNumber)
+            ->default_val(MAX_CONCURRENT_OLLAMA_DEFAULT);
+
+        app.add_option("--pipeline-queue", cfg.pipeline_queue,
+                       "Entries whose subtitles may be fetched ahead of the "
+                       "LLM. When it's full, yt-dlp waits for the LLM. 0 means "
+                       "--jobs-yt-tlp plus twice --jobs-requests")
+            ->default_val(0);
+
+        app.add_option("--max-concurrent-feeds", cfg.max_concurrent_feeds,
+                       "Feeds a server processes at once. Further ones get "
+                       "503 Service Unavailable with Retry-After, or cached "
+                       "summaries only with --overload-cached-only. 0 means "
+                       "no limit")
+            ->default_val(0);
+
+        app.add_option("--max-queued-jobs", cfg.max_queued_jobs,
+                       "Entries of feeds being summarized past which a "
+                       "server takes no new feeds, like with "
+                       "--max-concurrent-feeds. 0 means no limit")
+            ->default_val(0);
+
+        app.add_flag("--overload-cached-only", cfg.overload_cached_only,
+                     "Answer feeds over --max-concurrent-feeds or "
+                     "--max-queued-jobs with cached summaries only instead "
+                     "of 503");
+
+        app.add_option("--max-connections", cfg.max_connections,
+                       "Connections a server keeps open at once. Further "
+                       "ones wait to be accepted")
+            ->check(CLI::PositiveNumber)
+            ->default_val(MAX_CONNECTIONS_DEFAULT);
+
+        app.add_option("--request-header-limit", cfg.request_header_limit,
+                       "Size limit of headers of a request to a server, "
+                       "e.g. 8KB. Larger ones get 431")
+            ->transform(CLI::AsSizeValue(false))
+            ->default_val(REQUEST_HEADER_LIMIT_DEFAULT);
+
+        app.add_option("--request-body-limit", cfg.request_body_limit,
+                       "Size limit of a body of a request to a server, e.g. "
+                       "1MB. Larger ones get 413")
+            ->transform(CLI::AsSizeValue(false))
+            ->default_val(REQUEST_BODY_LIMIT_DEFAULT);
+
+        app.add_option("--request-timeout", cfg.request_timeout_seconds,
+                       "Seconds a client has to send a whole request to a "
+                       "server before the connection is closed")
+            ->check(CLI::PositiveNumber)
+            ->default_val(REQUEST_TIMEOUT_SECONDS_DEFAULT);
+
+        app.add_option("--response-timeout", cfg.response_timeout_seconds,
+                       "Seconds a client has to read a whole response of a "
+                       "server before the connection is closed")
+            ->check(CLI::PositiveNumber)
+            ->default_val(RESPONSE_TIMEOUT_SECONDS_DEFAULT);
+
+        app.set_config("--config", "",
+                       "TOML or INI file with options, e.g. jobs-requests = 4. "
+                       "Options given here take precedence. A server reads it "
+                       "again on SIGHUP or POST /admin/reload");
+        try
+            {
+                app.parse(argc, argv);
+
+                // Post-processing complex types
+                cfg.url = boost::urls::url(url_str);
+
+                auto verb_opt
+                    = magic_enum::enum_cast<beast::http::verb>(method_str);
+                if (!verb_opt)
+                    {
+                        throw CLI::ValidationError(
+                            "method", "Invalid HTTP method: " + method_str);
+                    }
+                cfg.method = *verb_opt;
+
+                if (not response_parser_plugin.empty())
+                    {
+                        try
+                            {
+                                cfg.response_parser = boost::dll::import_alias<
+                                    ABCResponseParser>(
+                                    response_parser_plugin,
+                                    RESPONSE_PARSER_PLUGIN_ALIAS);
+                            }
+                        // std::system_error with BOOST_DLL_USE_STD_FS.
+                        catch (boost::dll::fs::system_error const& e)
+                            {
+                                throw CLI::ValidationError(
+                                    "response-parser-plugin", e.what());
+                            }
+                    }
+                else
+                    {
+                        cfg.response_parser
+                            = make_response_parser(response_format_str);
+                        if (cfg.response_parser == nullptr)
+                            {
+                                throw CLI::ValidationError(
+                                    "response-format",
+                                    "Invalid response format: "
+                                        + response_format_str);
+                            }
+                    }
+                if (not cfg.response_parser_command.empty()
+                    || not cfg.yt_dlp_worker.empty())
+                    {
+                        // A command that exits without reading the whole
+                        // response, or a worker that died, must not kill the
+                        // app.
+                        std::signal(SIGPIPE, SIG_IGN);
+                    }
+
+                boost::algorithm::split(cfg.languages, cfg.language,
+                                        [](char c) { return c == ','; });
+                std::erase(cfg.languages, "");
+                if (cfg.languages.empty())
+                    {
+                        throw CLI::ValidationError("language",
+                                                   "No language of subtitles");
+                    }
+                for (auto const& language : cfg.languages)
+                    {
+                        if (not RE2(language, RE2::Quiet).ok())
+                            {
+                                throw CLI::ValidationError(
+                                    "language", "Invalid regex: " + language);
+                            }
+                    }
+
+                cfg.retry_backoff
+                    = {.base = std::chrono::minutes(retry_backoff_minutes),
+                       .max = std::chrono::hours(retry_backoff_max_hours)};
+
+                if (cfg.pipeline_queue == 0)
+                    {
+                        cfg.pipeline_queue = cfg.concurrency_yt_dlp
+                                             + 2 * cfg.concurrency_ollama;
+                    }
+
+                cfg.log_level = quill::loglevel_from_string(log_level_str);
+                cfg.feed_source = boost::urls::url(feed_source_str);
+
+                auto backend_opt = magic_enum::enum_cast<CacheBackend>(
+                    cache_backend_str, magic_enum::case_insensitive);
+                if (!backend_opt)
+                    {
+                        throw CLI::ValidationError(
+                            "cache-backend",
+                            "Invalid cache backend: " + cache_backend_str);
+                    }
+    #ifndef YTTO_WITH_LMDB
+                if (*backend_opt == CacheBackend::Lmdb)
+                    {
+                        throw CLI::ValidationError(
+                            "cache-backend", "This build has no LMDB support");
+                    }
+    #endif
+                cfg.cache_backend = *backend_opt;
+    #ifndef YTTO_WITH_NGHTTP2
+                if (cfg.http2)
+                    {
+                        throw CLI::ValidationError(
+                            "http2", "This build has no HTTP/2 support");
+                    }
+    #endif
+
+                auto eviction_opt = magic_enum::enum_cast<EvictionPolicy>(
+                    cache_eviction_str, magic_enum::case_insensitive);
+                if (!eviction_opt)
+                    {
+                        throw CLI::ValidationError(
+                            "cache-eviction",
+                            "Invalid eviction policy: " + cache_eviction_str);
+                    }
+                cfg.cache_janitor.policy = *eviction_opt;
+                cfg.cache_subtitles_janitor.policy = *eviction_opt;
+                cfg.cache_janitor.ttl = std::chrono::days(cache_ttl_days);
+                cfg.cache_subtitles_janitor.ttl
+                    = std::chrono::days(cache_subtitles_ttl_days);
+
+                cfg.model = model_of_body_template(cfg.http_body_template);
+                cfg.summary_version
+                    = summary_version(cfg.prompt_template, cfg.model);
+                try
+                    {
+                        cfg.request_templates
+                            = std::make_shared<RequestTemplates>(
+                                cfg.prompt_template, cfg.http_body_template);
+                    }
+                catch (inja::InjaError const& e)
+                    {
+                        throw CLI::ValidationError("template", e.what());
+                    }
+
+                if (not otlp_url_str.empty())
+                    {
+                        cfg.otlp_url = boost::urls::url(otlp_url_str);
+                    }
+
+                for (const auto& header_raw_str : headers_raw)
+                    {
+                        std::vector<std::string> parts;
+                        boost::split(parts, header_raw_str,
+                                     boost::is_any_of(":"));
+                        if (parts.size() >= 2)
+                            {
+                                std::string key = boost::trim_copy(parts[0]);
+                                std::string val = boost::trim_copy(parts[1]);
+                                cfg.headers.insert(key, val);
+                            }
+                    }
+
+                payload_log.configure(log_payload_limit, log_payload_sample);
+            }
+        catch (const CLI::ParseError& e)
+            {
+                return std::unexpected(app.exit(e, out, err));
+            }
+        return cfg;
+    }
+
+    /// Whether a server should take no new feeds: over --max-concurrent-feeds
+    /// or --max-queued-jobs. Entries of feeds already taken aren't limited,
+    /// so jobs go over the limit by at most a feed.
+    bool overloaded(Config const& cfg)
+    {
+        return (cfg.max_concurrent_feeds != 0
+                && std::cmp_greater_equal(metrics.admission.feeds.value(),
+                                          cfg.max_concurrent_feeds))
+               || (cfg.max_queued_jobs != 0
+                   && std::cmp_greater_equal(metrics.admission.jobs.value(),
+                                             cfg.max_queued_jobs));
+    }
+
+    /**
+     * Parses the command line and --config again and swaps current_config
+     * for the result. Options that are set up once at start, like caches,
+     * listeners, tracing and workers, keep their values. Limits of
+     * `pipeline` are resized in place; feeds being processed finish with the
+     * config they started with.
+     */
+    std::expected<void, std::string> reload_config(Pipeline& pipeline)
+    {
+        std::ostringstream out;
+        std::ostringstream err;
+        Config cfg;
+        try
+            {
+                std::expected<Config, int> parsed
+                    = parse_config(static_cast<int>(command_line.size()),
+                                   command_line.data(), out, err);
+                if (!parsed)
+                    {
+                        return std::unexpected(err.str() + out.str());
+                    }
+                cfg = std::move(*parsed);
+
+                Config const& running = *current_config;
+                cfg.cache_file = running.cache_file;
+                cfg.cache_subtitles_file = running.cache_subtitles_file;
+                cfg.cache_backend = running.cache_backend;
+                cfg.lmdb_map_size = running.lmdb_map_size;
+                cfg.cache_janitor = running.cache_janitor;
+                cfg.cache_subtitles_janitor = running.cache_subtitles_janitor;
+                cfg.log_file = running.log_file;
+                cfg.trace_file = running.trace_file;
+                cfg.otlp_url = running.otlp_url;
+                cfg.trace_buffer_spans = running.trace_buffer_spans;
+                cfg.trace_export_interval_seconds
+                    = running.trace_export_interval_seconds;
+                cfg.llm_usage_log_interval_seconds
+                    = running.llm_usage_log_interval_seconds;
+                cfg.job_journal_file = running.job_journal_file;
+                cfg.daemon_socket = running.daemon_socket;
+                cfg.server_port = running.server_port;
+                cfg.max_connections = running.max_connections;
+                cfg.enable_server = running.enable_server;
+                cfg.http2 = running.http2;
+                cfg.yt_dlp_worker = running.yt_dlp_worker;
+                cfg.yt_dlp_worker_jobs = running.yt_dlp_worker_jobs;
+                cfg.no_subtitles_ttl_hours = running.no_subtitles_ttl_hours;
+                cfg.retry_backoff = running.retry_backoff;
+                cfg.regenerate_jobs = running.regenerate_jobs;
+
+                // A new prompt or model makes a new version of summaries;
+                // the current one becomes stale and is regenerated.
+                SummaryVersions summary_versions(
+                    cfg.cache_file / "summary_versions", cfg.summary_version,
+                    cfg.model);
+                cfg.stale_summary_versions = summary_versions.previous();
+            }
+        catch (std::exception& e)
+            {
+                return std::unexpected(e.what());
+            }
+
+        logger->set_log_level(cfg.log_level);
+        pipeline.resize(cfg);
+        current_config = std::make_shared<Config const>(std::move(cfg));
+        LOG_INFO(logger,
+                 "Reloaded the config. Version of summaries: {}. yt-dlp "
+                 "jobs: {}, LLM jobs: {}, queue: {}",
+                 current_config->summary_version, pipeline.yt_dlp.size(),
+                 pipeline.llm.size(), pipeline.queue.size());
+        return {};
+    }
+
+    /// Reloads the config on every SIGHUP.
+    corral::Task<void> reload_on_sighup(auto& ioc, Pipeline& pipeline)
+    {
+        net::signal_set signals(ioc, SIGHUP);
+        while (true)
+            {
+                auto [ec, signal_number] = co_await signals.async_wait(
+                    corral::asio_nothrow_awaitable);
+                if (ec)
+                    {
+                        co_return;
+                    }
+                LOG_INFO(logger, "Got SIGHUP. Reloading the config...");
+                auto res = reload_config(pipeline);
+                if (!res)
+                    {
+                        LOG_WARNING(logger,
+                                    "Failed to reload the config, keeping "
+                                    "the running one: {}",
+                                    res.error());
+                    }
+            }
+    }
 
-        corral::Semaphore semaphore_yt_dlp(cfg.concurrency_yt_dlp);
-        corral::Semaphore semaphore_ollama(cfg.concurrency_ollama);
-        std::string res
-            = co_await main_logic(ioc, tree, cache, cache_subtitles, cfg,
-                                  semaphore_yt_dlp, semaphore_ollama);
-        fmt::println("{}", res);
+    /// Where a connection comes from, for the endpoints that are not meant
+    /// for everyone who can reach the TCP port.
+    enum class Peer
+    {
+        DaemonSocket,
+        Loopback,
+        Remote,
+    };
+
+    Peer peer_of(net::local::stream_protocol::socket const&)
+    {
+        return Peer::DaemonSocket;
+    }
+
+    Peer peer_of(net::ip::tcp::socket const& socket)
+    {
+        boost::system::error_code ec;
+        auto const endpoint = socket.remote_endpoint(ec);
+        return not ec and endpoint.address().is_loopback() ? Peer::Loopback
+                                                           : Peer::Remote;
     }
 
     corral::Task<http::message_generator> handle_request(
         auto& ioc, auto&& req, ABCCache& cache, ABCCache& cache_subtitles,
-        Config const& cfg, corral::Semaphore& semaphore_yt_dlp,
-        corral::Semaphore& semaphore_ollama)
+        std::shared_ptr<Config const> config, Pipeline& pipeline,
+        corral::Nursery& background, Peer peer)
     {
+        Config const& cfg = *config;
         auto const bad_request = [&req](beast::string_view why)
             {
                 http::response<http::string_body> res{http::status::bad_request,
@@ -632,48 +2650,224 @@ namespace
                 return res;
             };
 
+        auto const forbidden = [&req]()
+            {
+                http::response<http::string_body> res{http::status::forbidden,
+                                                      req.version()};
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type, "text/html");
+                res.keep_alive(req.keep_alive());
+                res.body() = "Not allowed from this connection";
+                res.prepare_payload();
+                return res;
+            };
+
+        auto const unavailable = [&req]()
+            {
+                http::response<http::string_body> res{
+                    http::status::service_unavailable, req.version()};
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type, "text/html");
+                res.set(http::field::retry_after,
+                        std::to_string(OVERLOAD_RETRY_AFTER.count()));
+                res.keep_alive(req.keep_alive());
+                res.body() = "The server is overloaded, retry later";
+                res.prepare_payload();
+                return res;
+            };
+
+        // std::nullopt if a feed is refused, otherwise whether it gets cached
+        // summaries only.
+        auto const admit = [&cfg]() -> std::optional<bool>
+            {
+                if (not overloaded(cfg))
+                    {
+                        return false;
+                    }
+                if (not cfg.overload_cached_only)
+                    {
+                        LOG_INFO(logger, "Overloaded. Refusing a feed.");
+                        metrics.admission.rejected.inc();
+                        return std::nullopt;
+                    }
+                LOG_INFO(logger,
+                         "Overloaded. Serving a feed with cached summaries "
+                         "only.");
+                metrics.admission.cached_only.inc();
+                return true;
+            };
+
+        if (req.method() == http::verb::post && req.target() == "/process-feed")
+            {
+                // Only the stdin mode forwards feeds, and it does so over
+                // --daemon-socket.
+                if (peer != Peer::DaemonSocket)
+                    {
+                        co_return forbidden();
+                    }
+                std::optional<bool> const cached_only = admit();
+                if (not cached_only.has_value())
+                    {
+                        co_return unavailable();
+                    }
+                GaugeGuard feed_in_flight(metrics.admission.feeds);
+                ScopedTimer request_timer(metrics.request_duration);
+                Span span = Span::root(tracer, "forwarded_feed");
+                Span stage = span.child("parse_feed");
+                boost::property_tree::ptree tree;
+                try
+                    {
+                        tree = parse_rss_into_tree(req.body());
+                    }
+                catch (boost::property_tree::ptree_error const& e)
+                    {
+                        metrics.fail(FailureKind::BadRequest);
+                        co_return bad_request(e.what());
+                    }
+                stage.end();
+
+                http::response<http::string_body> res(http::status::ok,
+                                                      req.version());
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type, "text/xml");
+                res.keep_alive(req.keep_alive());
+                // Well-formed XML may still lack <feed> or an entry may lack
+                // a part of it.
+                try
+                    {
+                        res.body() = co_await main_logic(
+                            ioc, std::move(tree), cache, cache_subtitles,
+                            config, pipeline, background, span, *cached_only);
+                    }
+                catch (boost::property_tree::ptree_error const& e)
+                    {
+                        metrics.fail(FailureKind::BadRequest);
+                        co_return bad_request(e.what());
+                    }
+                res.prepare_payload();
+                co_return res;
+            }
+
+        if (req.method() == http::verb::post && req.target() == "/admin/reload")
+            {
+                if (peer == Peer::Remote)
+                    {
+                        co_return forbidden();
+                    }
+                auto reloaded = reload_config(pipeline);
+                if (!reloaded)
+                    {
+                        LOG_WARNING(logger,
+                                    "Failed to reload the config, keeping "
+                                    "the running one: {}",
+                                    reloaded.error());
+                        co_return bad_request(reloaded.error());
+                    }
+                http::response<http::string_body> res(http::status::ok,
+                                                      req.version());
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type, "text/plain");
+                res.keep_alive(req.keep_alive());
+                res.body() = current_config->summary_version;
+                res.prepare_payload();
+                co_return res;
+            }
+
         if (req.method() != http::verb::get)
             {
+                metrics.fail(FailureKind::BadRequest);
                 co_return bad_request("Unknown HTTP-method");
             }
 
+        if (req.target() == "/metrics")
+            {
+                http::response<http::string_body> res(http::status::ok,
+                                                      req.version());
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type,
+                        "text/plain; version=0.0.4");
+                res.keep_alive(req.keep_alive());
+                res.body() = metrics.render();
+                llm_usage.render(res.body());
+                res.prepare_payload();
+                co_return res;
+            }
+
+        ScopedTimer request_timer(metrics.request_duration);
+        Span span = Span::root(tracer, "request");
+
         if (req.target().empty() || req.target()[0] != '/'
             || req.target().find("..") != beast::string_view::npos)
             {
+                metrics.fail(FailureKind::BadRequest);
                 co_return bad_request("Illegal request-target");
             }
 
         auto res_json = glz::read_json<RequestServer>(req.body());
         if (!res_json)
             {
+                metrics.fail(FailureKind::BadRequest);
                 co_return bad_request("Request is not correct.");
             }
 
         const auto& json = res_json.value();
 
+        std::string channel_id;
         if (not RE2::FullMatch(
                 json.url,
-                R"(^https:\/\/www\.youtube\.com\/feeds\/videos\.xml\?channel_id=UC[a-zA-Z0-9_-]{22}$)"))
+                R"(^https:\/\/www\.youtube\.com\/feeds\/videos\.xml\?channel_id=(UC[a-zA-Z0-9_-]{22})$)",
+                &channel_id))
             {
+                metrics.fail(FailureKind::BadRequest);
                 co_return bad_request(
                     "Provided URL does not look like an YouTube's URL to an "
                     "RSS "
                     "feed.");
             }
 
-        boost::url url_youtube_rss_feed(json.url);
+        std::optional<bool> const cached_only = admit();
+        if (not cached_only.has_value())
+            {
+                co_return unavailable();
+            }
+        GaugeGuard feed_in_flight(metrics.admission.feeds);
 
-        auto rss_res = co_await typical_https_request(
-            ioc, "", url_youtube_rss_feed, http::verb::get, http::fields{});
+        boost::url url_youtube_rss_feed = cfg.feed_source;
+        url_youtube_rss_feed.params().set("channel_id", channel_id);
+        span.annotate(json.url);
+
+        std::expected<std::pmr::string, std::string> rss_res;
+        {
+            ScopedTimer feed_timer(metrics.feed_fetch_duration);
+            Span stage = span.child("fetch_feed");
+            rss_res = co_await typical_request(ioc, "", url_youtube_rss_feed,
+                                               http::verb::get, http::fields{},
+                                               stage);
+        }
 
         if (!rss_res)
             {
+                metrics.fail(FailureKind::FeedFetch);
                 co_return server_error(rss_res.error());
             }
 
-        std::string response_body = co_await main_logic(
-            ioc, parse_rss_into_tree(*rss_res), cache, cache_subtitles, cfg,
-            semaphore_yt_dlp, semaphore_ollama);
+        std::string response_body;
+        try
+            {
+                Span stage = span.child("parse_feed");
+                boost::property_tree::ptree tree
+                    = parse_rss_into_tree(*rss_res);
+                stage.end();
+
+                response_body = co_await main_logic(
+                    ioc, std::move(tree), cache, cache_subtitles, config,
+                    pipeline, background, span, *cached_only);
+            }
+        catch (boost::property_tree::ptree_error const& e)
+            {
+                metrics.fail(FailureKind::FeedFetch);
+                co_return server_error(e.what());
+            }
 
         http::response<http::string_body> res(http::status::ok, req.version());
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
@@ -685,47 +2879,103 @@ namespace
         co_return res;
     }
 
-    corral::Task<void> serve(auto& ioc, beast::tcp_stream stream,
+    /**
+     * Reads a request from a connection within --request-timeout and
+     * --request-header-limit/--request-body-limit, handles it and writes the
+     * response within --response-timeout. A client too slow for either is
+     * dropped, so that it holds neither this task nor memory. `connection`
+     * is a slot of --max-connections.
+     */
+    corral::Task<void> serve(auto& ioc, auto socket,
                              ABCCache& cache, ABCCache& cache_subtitles,
-                             Config const& cfg,
-                             corral::Semaphore& semaphore_yt_dlp,
-                             corral::Semaphore& semaphore_ollama)
+                             Pipeline& pipeline, corral::Nursery& background,
+                             [[maybe_unused]] ResizableSemaphore::Lock
+                                 connection)
     {
-        beast::flat_buffer buffer;
-
-        beast::http::request<http::string_body> req;
-        auto [ec, bytes_read] = co_await beast::http::async_read(
-            stream, buffer, req, corral::asio_nothrow_awaitable);
+        GaugeGuard open(metrics.admission.connections);
+        // The request is handled with the config of when it came, even if a
+        // reload swaps it meanwhile.
+        std::shared_ptr<Config const> config = current_config;
+        Peer const peer = peer_of(socket);
+        beast::basic_stream<typename decltype(socket)::protocol_type> stream(
+            std::move(socket));
+
+        auto const send = [&](http::message_generator response)
+            -> corral::Task<void>
+            {
+                LOG_INFO(logger, "Sending response...");
+                stream.expires_after(
+                    std::chrono::seconds(config->response_timeout_seconds));
+                auto [ec_write, bytes_written] = co_await beast::async_write(
+                    stream, std::move(response),
+                    corral::asio_nothrow_awaitable);
+                if (ec_write == beast::error::timeout)
+                    {
+                        LOG_INFO(logger,
+                                 "A client didn't read a response in {}s.",
+                                 config->response_timeout_seconds);
+                        metrics.fail(FailureKind::ClientTimeout);
+                    }
+            };
 
+        beast::flat_buffer buffer;
+        http::request_parser<http::string_body> parser;
+        parser.header_limit(static_cast<std::uint32_t>(
+            std::min<size_t>(config->request_header_limit,
+                             std::numeric_limits<std::uint32_t>::max())));
+        parser.body_limit(config->request_body_limit);
+        stream.expires_after(
+            std::chrono::seconds(config->request_timeout_seconds));
+        auto [ec, bytes_read] = co_await http::async_read(
+            stream, buffer, parser, corral::asio_nothrow_awaitable);
+
+        if (ec == beast::error::timeout)
+            {
+                LOG_INFO(logger, "A client didn't send a request in {}s.",
+                         config->request_timeout_seconds);
+                metrics.fail(FailureKind::ClientTimeout);
+                co_return;
+            }
+        if (ec == http::error::header_limit || ec == http::error::body_limit)
+            {
+                metrics.fail(FailureKind::BadRequest);
+                http::response<http::string_body> res{
+                    ec == http::error::header_limit
+                        ? http::status::request_header_fields_too_large
+                        : http::status::payload_too_large,
+                    HTTP_VERSION_TO_USE};
+                res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+                res.set(http::field::content_type, "text/html");
+                res.keep_alive(false);
+                res.body() = ec.message();
+                res.prepare_payload();
+                co_await send(std::move(res));
+                co_return;
+            }
         if (ec)
             {
                 co_return;
             }
 
-        auto response_generator = co_await handle_request(
-            ioc, std::move(req), cache, cache_subtitles, cfg, semaphore_yt_dlp,
-            semaphore_ollama);
-
-        LOG_INFO(logger, "Sending response...");
-        auto [ec_write, bytes_written]
-            = co_await beast::async_write(stream, std::move(response_generator),
-                                          corral::asio_nothrow_awaitable);
+        co_await send(co_await handle_request(ioc, parser.release(), cache,
+                                              cache_subtitles, config,
+                                              pipeline, background, peer));
     }
 
-    corral::Task<void> server_acceptor(auto& ioc, ABCCache& cache,
-                                       ABCCache& cache_subtitles,
-                                       Config const& cfg)
+    /// Accepts connections of either TCP or a Unix domain socket. Once
+    /// `connections` are all open, new ones wait in the backlog of the socket.
+    corral::Task<void> accept_connections(auto& ioc, auto& acceptor,
+                                          ABCCache& cache,
+                                          ABCCache& cache_subtitles,
+                                          Pipeline& pipeline,
+                                          ResizableSemaphore& connections)
     {
-        corral::Semaphore semaphore_yt_dlp(cfg.concurrency_yt_dlp);
-        corral::Semaphore semaphore_ollama(cfg.concurrency_ollama);
-
-        net::ip::tcp::acceptor acceptor(
-            ioc, net::ip::tcp::endpoint(boost::asio::ip::tcp::v4(),
-                                        cfg.server_port));
         CORRAL_WITH_NURSERY(nursery)
         {
             while (true)
                 {
+                    ResizableSemaphore::Lock connection
+                        = co_await connections.lock();
                     auto [ec, sock] = co_await acceptor.async_accept(
                         corral::asio_nothrow_awaitable);
                     if (ec)
@@ -733,175 +2983,214 @@ namespace
                             continue;
                         }
 
-                    beast::tcp_stream stream{std::move(sock)};
                     LOG_INFO(logger, "New connection");
 
                     nursery.start(
-                        [&](beast::tcp_stream stream) mutable
+                        [&](auto stream,
+                            ResizableSemaphore::Lock slot) mutable
                             {
                                 return serve(ioc, std::move(stream), cache,
-                                             cache_subtitles, cfg,
-                                             semaphore_yt_dlp,
-                                             semaphore_ollama);
+                                             cache_subtitles, pipeline,
+                                             nursery, std::move(slot));
                             },
-                        std::move(stream));
+                        std::move(sock), std::move(connection));
+                }
+        };
+    }
+
+    corral::Task<void> server_acceptor(auto& ioc, ABCCache& cache,
+                                       ABCCache& cache_subtitles,
+                                       Config const& cfg)
+    {
+        Pipeline pipeline(cfg);
+        // Shared by both acceptors.
+        ResizableSemaphore connections(cfg.max_connections);
+
+        net::ip::tcp::acceptor acceptor(
+            ioc, net::ip::tcp::endpoint(boost::asio::ip::tcp::v4(),
+                                        cfg.server_port));
+
+        std::optional<net::local::stream_protocol::acceptor> local_acceptor;
+        if (not cfg.daemon_socket.empty())
+            {
+                // A socket file left by a killed server would fail bind().
+                std::filesystem::remove(cfg.daemon_socket);
+                local_acceptor.emplace(ioc,
+                                       net::local::stream_protocol::endpoint(
+                                           cfg.daemon_socket.string()));
+                LOG_INFO(logger, "Listening for feeds from stdin mode at {}",
+                         cfg.daemon_socket.string());
+            }
+
+        CORRAL_WITH_NURSERY(nursery)
+        {
+            nursery.start(
+                [&]
+                    {
+                        return resume_jobs(ioc, cache, cache_subtitles, cfg,
+                                           pipeline);
+                    });
+            nursery.start(
+                [&]
+                    {
+                        return regenerate_stale(
+                            ioc, cache, cache_subtitles, cfg, pipeline, false);
+                    });
+            if (local_acceptor.has_value())
+                {
+                    nursery.start(
+                        [&]
+                            {
+                                return accept_connections(
+                                    ioc, *local_acceptor, cache,
+                                    cache_subtitles, pipeline, connections);
+                            });
                 }
+            nursery.start([&] { return reload_on_sighup(ioc, pipeline); });
+            co_await accept_connections(ioc, acceptor, cache, cache_subtitles,
+                                        pipeline, connections);
+            co_return corral::join;
         };
     }
 
+    /// Why a server started with --daemon-socket didn't process a feed.
+    struct DaemonError
+    {
+        // False if there's no server to connect to, then the feed can be
+        // processed in this process instead.
+        bool reached;
+        std::string what;
+    };
+
+    /// Hands a feed to a server started with --daemon-socket, so that
+    /// concurrent invocations share its limits and its warm caches.
+    corral::Task<std::expected<std::string, DaemonError>> forward_to_daemon(
+        auto& ioc, std::string const& feed, Config const& cfg)
+    {
+        net::local::stream_protocol::socket socket(ioc);
+        auto [ec_connect] = co_await socket.async_connect(
+            net::local::stream_protocol::endpoint(cfg.daemon_socket.string()),
+            corral::asio_nothrow_awaitable);
+        if (ec_connect)
+            {
+                co_return std::unexpected(DaemonError{
+                    .reached = false, .what = ec_connect.message()});
+            }
+
+        http::request<http::string_body> request{
+            http::verb::post, "/process-feed", HTTP_VERSION_TO_USE, feed};
+        request.set(http::field::host, "localhost");
+        request.set(http::field::content_type, "text/xml");
+        request.prepare_payload();
+        auto [ec_write, bytes_written] = co_await http::async_write(
+            socket, request, corral::asio_nothrow_awaitable);
+        if (ec_write)
+            {
+                co_return std::unexpected(
+                    DaemonError{.reached = true, .what = ec_write.message()});
+            }
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> response;
+        auto [ec_read, bytes_read] = co_await http::async_read(
+            socket, buffer, response, corral::asio_nothrow_awaitable);
+        if (ec_read)
+            {
+                co_return std::unexpected(
+                    DaemonError{.reached = true, .what = ec_read.message()});
+            }
+        if (response.result() != http::status::ok)
+            {
+                co_return std::unexpected(DaemonError{
+                    .reached = true,
+                    .what = fmt::format("returned with status {}: {}",
+                                        response.result_int(),
+                                        response.body())});
+            }
+        co_return std::move(response.body());
+    }
+
+    corral::Task<void> export_traces(auto& ioc, Config const& cfg)
+    {
+        if (not cfg.trace_file.empty() && tracer.has_new_spans())
+            {
+                fmt::output_file(cfg.trace_file.string())
+                    .print("{}", tracer.to_chrome_trace());
+            }
+
+        if (cfg.otlp_url.empty())
+            {
+                co_return;
+            }
+        std::string body = tracer.take_otlp_json();
+        if (body.empty())
+            {
+                co_return;
+            }
+        http::fields headers;
+        headers.set(http::field::content_type, "application/json");
+        auto res = co_await typical_request(ioc, body, cfg.otlp_url,
+                                            http::verb::post, headers, Span{});
+        if (!res)
+            {
+                LOG_WARNING(logger, "Failed to export traces to {}: {}",
+                            std::string(cfg.otlp_url.buffer()), res.error());
+            }
+    }
+
+    corral::Task<void> trace_exporter(auto& ioc, Config const& cfg)
+    {
+        if (not tracer.enabled())
+            {
+                co_await corral::SuspendForever{};
+            }
+        while (true)
+            {
+                co_await corral::sleepFor(
+                    ioc,
+                    std::chrono::seconds(cfg.trace_export_interval_seconds));
+                co_await export_traces(ioc, cfg);
+            }
+    }
+
+    std::unique_ptr<ABCCache> make_cache(std::filesystem::path const& folder,
+                                         Config const& cfg)
+    {
+        switch (cfg.cache_backend)
+            {
+#ifdef YTTO_WITH_LMDB
+                case CacheBackend::Lmdb:
+                    return std::make_unique<CacheLmdb>(folder,
+                                                       cfg.lmdb_map_size);
+#endif
+                default:
+                    return std::make_unique<CacheHexHashFile>(folder);
+            }
+    }
 }  // namespace
 
 int main(int argc, char* argv[])
 {
     Config cfg;
+    command_line.assign(argv, argv + argc);
 
-    CLI::App app{
-        "Post-processor for YouTube's RSS feed, so that you get "
-        "summary of video inside the feed via sending an HTTP "
-        "request to something like an Ollama instance."};
-
-    // Temporary storage for CLI11 to map types it doesn't handle natively
-    // without custom validators
-    std::string url_str = "http://127.0.0.1:11434/api/chat";
-    std::string method_str = "post";
-    std::vector<std::string> headers_raw = {"Content-Type: application/json"};
-    std::string log_level_str = "info";
-
-    app.add_option("-c,--cache-folder", cfg.cache_file,
-                   "Folder, in which there will be files as cache of result "
-                   "of summarization")
-        ->required();
-
-    app.add_option("-S,--cache-folder-subtitles", cfg.cache_subtitles_file,
-                   "Folder, in which there will be files as subtitles of a "
-                   "specific YouTube link.")
-        ->required();
-
-    app.add_option("-L,--language", cfg.language,
-                   "yt-dlp language of subtitles")
-        ->capture_default_str()
-        ->default_val("en");
-
-    app.add_option(
-           "-u,--url", url_str,
-           "URL of ?Ollama? instance in format http://127.0.0.1:11434/api/chat")
-        ->capture_default_str();
-
-    app.add_option("-X,--method", method_str,
-                   "HTTP method by which to ask an ?Ollama? instance. "
-                   "Possible values: get, post, head, patch, purge etc.")
-        ->capture_default_str();
-
-    app.add_option("-T,--template", cfg.http_body_template,
-                   "Jinja template for HTTP request to an ?Ollama? instance.")
-        ->default_val(R"({
-    "model": "gemma3:4b-it-qat",
-    "stream": false,
-    "messages": [
-      {
-        "role": "user",
-        "content": "{{ prompt }}"
-      }
-    ]
-})");
-
-    app.add_option("-P,--prompt", cfg.prompt_template,
-                   "Prompt's Jinja template for an LLM")
-        ->default_val(
-            R"(Always be brutally honest (to the point of being a little bit rude), smart, and extremely laconic. 
-Do not rewrite instructions provided by user.
-You will be supplied with author's name, title, description and subtitles of a YouTube video. 
-Please, provide a summary with main points.
-
-Author's name:
-
-```
-{{ author }}
-```
-
-Title:
-```
-{{ title }}
-```
-
-```
-{{ description }}
-```
-
-Subtitles:
-
-```
-{{ subtitles }}
-```
-)");
-
-    app.add_option("-H,--header", headers_raw,
-                   "HTTP headers for request to an ?Ollama? instance.")
-        ->take_all();
-
-    app.add_option("-l,--log-file", cfg.log_file, "Filepath to internal logs")
-        ->default_val("./logs.log");
-
-    app.add_option(
-           "--log-level", log_level_str,
-           "Log level: "
-           "tracel3,tracel2,tracel1,debug,info,notice,warning,error,critical")
-        ->default_val("info");
-
-    app.add_flag("-s,--proceed-shorts", cfg.proceed_with_shorts,
-                 "Try do with shorts");
-
-    app.add_flag("-A,--enable-server", cfg.enable_server, "Enable server")
-        ->default_val(false);
-    app.add_flag("-p,--port", cfg.server_port, "Server's port")
-        ->check(CLI::PositiveNumber)
-        ->default_val(SERVER_DEFAULT_PORT);
-
-    app.add_option(
-           "-j,--jobs-yt-tlp", cfg.concurrency_yt_dlp,
-           "Amount of concurrent yt-dlp processes created by this application.")
-        ->check(CLI::PositiveNumber)
-        ->default_val(MAX_CONCURRENT_YTDLP_DEFAULT);
-
-    app.add_option("-J,--jobs-requests", cfg.concurrency_ollama,
-                   "Amount of concurrent request to an ?Ollama? instance sent "
-                   "by this application")
-        ->check(CLI::PositiveNumber)
-        ->default_val(MAX_CONCURRENT_OLLAMA_DEFAULT);
     try
         {
-            app.parse(argc, argv);
-
-            // Post-processing complex types
-            cfg.url = boost::urls::url(url_str);
-
-            auto verb_opt
-                = magic_enum::enum_cast<beast::http::verb>(method_str);
-            if (!verb_opt)
+            std::expected<Config, int> parsed
+                = parse_config(argc, argv, std::cout, std::cerr);
+            if (!parsed)
                 {
-                    throw CLI::ValidationError(
-                        "method", "Invalid HTTP method: " + method_str);
+                    return parsed.error();
                 }
-            cfg.method = *verb_opt;
-
-            cfg.log_level = quill::loglevel_from_string(log_level_str);
+            cfg = std::move(*parsed);
 
-            for (const auto& header_raw_str : headers_raw)
+            if (not cfg.trace_file.empty() || not cfg.otlp_url.empty())
                 {
-                    std::vector<std::string> parts;
-                    boost::split(parts, header_raw_str, boost::is_any_of(":"));
-                    if (parts.size() >= 2)
-                        {
-                            std::string key = boost::trim_copy(parts[0]);
-                            std::string val = boost::trim_copy(parts[1]);
-                            cfg.headers.insert(key, val);
-                        }
+                    tracer.enable(
+                        cfg.trace_file.empty() ? 0 : cfg.trace_buffer_spans,
+                        not cfg.otlp_url.empty());
                 }
         }
-    catch (const CLI::ParseError& e)
-        {
-            return app.exit(e);
-        }
     catch (OmegaException<std::string>& e)
         {
             boost::stacktrace::basic_stacktrace<
@@ -987,24 +3276,138 @@ Subtitles:
 
             LOG_DEBUG(logger, "Successfully parsed command line arguments.");
 
-            CacheHexHashFile cache(cfg.cache_file);
+            net::io_context ioc;
+            std::string xml_rss_youtube_feed;
+            if (not cfg.enable_server)
+                {
+                    xml_rss_youtube_feed = read_feed_from_stdin();
+                }
+            if (not cfg.enable_server && not cfg.daemon_socket.empty())
+                {
+                    auto forwarded = corral::run(
+                        ioc, forward_to_daemon(ioc, xml_rss_youtube_feed, cfg));
+                    if (forwarded)
+                        {
+                            LOG_INFO(logger, "The feed was processed by {}",
+                                     cfg.daemon_socket.string());
+                            fmt::println("{}", *forwarded);
+                            return std::to_underlying(ReturnCodes::Success);
+                        }
+                    // A server that refused the feed, e.g. when overloaded,
+                    // must not get its work done by each of its clients.
+                    if (forwarded.error().reached)
+                        {
+                            std::string const log = fmt::format(
+                                "The server at {} failed the feed: {}\n",
+                                cfg.daemon_socket.string(),
+                                forwarded.error().what);
+                            fmt::print(std::cerr, "{}", log);
+                            LOG_ERROR(logger, "{}", log);
+                            return std::to_underlying(ReturnCodes::FailDaemon);
+                        }
+                    LOG_INFO(logger,
+                             "No server at {} ({}). Processing the feed "
+                             "in this process.",
+                             cfg.daemon_socket.string(),
+                             forwarded.error().what);
+                    ioc.restart();
+                }
+
+            std::unique_ptr<ABCCache> cache_ptr
+                = make_cache(cfg.cache_file, cfg);
+            ABCCache& cache = *cache_ptr;
             LOG_DEBUG(logger, "Successfully created cache object.");
-            CacheHexHashFile cache_subtitles(cfg.cache_subtitles_file);
+            std::unique_ptr<ABCCache> cache_subtitles_ptr
+                = make_cache(cfg.cache_subtitles_file, cfg);
+            ABCCache& cache_subtitles = *cache_subtitles_ptr;
             LOG_DEBUG(logger,
                       "Successfully created cache object for subtitles.");
 
+            SummaryVersions summary_versions(
+                cfg.cache_file / "summary_versions", cfg.summary_version,
+                cfg.model);
+            cfg.stale_summary_versions = summary_versions.previous();
+            CacheJanitor janitor(cfg.cache_file, cfg.cache_janitor);
+            CacheJanitor janitor_subtitles(cfg.cache_subtitles_file,
+                                           cfg.cache_subtitles_janitor);
+
+            RegenerationQueue regeneration;
+            if (cfg.regenerate_jobs != 0)
+                {
+                    regeneration_queue = &regeneration;
+                }
+            LOG_DEBUG(logger, "Version of summaries: {}", cfg.summary_version);
+
             LOG_INFO(logger, "Trying to parse supplied headers...");
 
-            net::io_context ioc;
+            std::optional<JobJournal> job_journal;
+            if (not cfg.job_journal_file.empty())
+                {
+                    job_journal.emplace(cfg.job_journal_file);
+                    journal = &*job_journal;
+                    LOG_DEBUG(logger,
+                              "Successfully opened the job journal. "
+                              "Unfinished jobs: {}",
+                              job_journal->outstanding().size());
+                }
+
+#ifdef YTTO_WITH_NGHTTP2
+            std::optional<Http2Pool> connections_http2;
+            if (cfg.http2)
+                {
+                    connections_http2.emplace(ioc, HTTP_MAX_TIME_TIMEOUT_RFC,
+                                              MAX_PROMPT_TIME);
+                    http2_pool = &*connections_http2;
+                }
+#endif
+
+            std::optional<NoSubtitlesCache> no_subtitles_cache;
+            if (cfg.no_subtitles_ttl_hours != 0)
+                {
+                    no_subtitles_cache.emplace(
+                        cfg.cache_subtitles_file / "no_subtitles",
+                        std::chrono::hours(cfg.no_subtitles_ttl_hours));
+                    no_subtitles = &*no_subtitles_cache;
+                }
+
+            std::optional<FailureCache> failure_cache;
+            if (cfg.retry_backoff.base.count() != 0)
+                {
+                    failure_cache.emplace(cfg.cache_file / "failures",
+                                          cfg.retry_backoff);
+                    failures = &*failure_cache;
+                }
+
+            std::optional<YtDlpWorkerPool> workers_yt_dlp;
+            if (not cfg.yt_dlp_worker.empty())
+                {
+                    workers_yt_dlp.emplace(ioc, cfg.yt_dlp_worker,
+                                           cfg.concurrency_yt_dlp,
+                                           cfg.yt_dlp_worker_jobs);
+                    yt_dlp_workers = &*workers_yt_dlp;
+                    LOG_DEBUG(logger, "Started {} yt-dlp workers.",
+                              cfg.concurrency_yt_dlp);
+                }
+
+            current_config = std::make_shared<Config const>(cfg);
+
             LOG_DEBUG(logger, "Entering coroutine...");
             net::signal_set signals(ioc, SIGINT, SIGTERM);
             if (not cfg.enable_server)
                 {
                     corral::run(
                         ioc, corral::anyOf(
-                                 async_main_no_server(ioc, cache,
-                                                      cache_subtitles, cfg),
-                                 signals.async_wait(corral::asio_awaitable)));
+                                 async_main_no_server(
+                                     ioc, xml_rss_youtube_feed, cache,
+                                     cache_subtitles, cfg),
+                                 signals.async_wait(corral::asio_awaitable),
+                                 trace_exporter(ioc, cfg),
+                                 journal_flusher(ioc), http2_connections(),
+                                 llm_usage_reporter(ioc, cfg),
+                                 clean_cache(ioc, janitor,
+                                             metrics.cache_summaries),
+                                 clean_cache(ioc, janitor_subtitles,
+                                             metrics.cache_subtitles)));
                 }
             else
                 {
@@ -1014,7 +3417,31 @@ Subtitles:
                         ioc,
                         corral::anyOf(
                             server_acceptor(ioc, cache, cache_subtitles, cfg),
-                            signals.async_wait(corral::asio_awaitable)));
+                            signals.async_wait(corral::asio_awaitable),
+                            trace_exporter(ioc, cfg), journal_flusher(ioc),
+                            http2_connections(), llm_usage_reporter(ioc, cfg),
+                            clean_cache(ioc, janitor, metrics.cache_summaries),
+                            clean_cache(ioc, janitor_subtitles,
+                                        metrics.cache_subtitles)));
+                }
+
+            if (cfg.llm_usage_log_interval_seconds != 0)
+                {
+                    log_llm_usage();
+                }
+
+            if (journal != nullptr)
+                {
+                    // Interrupted jobs stay in the journal as unfinished.
+                    LOG_INFO(logger, "Checkpointing the job journal...");
+                    journal->checkpoint();
+                }
+
+            if (tracer.enabled())
+                {
+                    LOG_DEBUG(logger, "Exporting remaining spans...");
+                    ioc.restart();
+                    corral::run(ioc, export_traces(ioc, cfg));
                 }
         }
     catch (OmegaException<std::filesystem::path>& e)
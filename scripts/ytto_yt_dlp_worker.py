@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""A long-lived yt-dlp for ytto's --yt-dlp-worker.
+
+Imports yt_dlp once and then fetches subtitles of one video after another, so
+that a video costs network requests only, not a start of the interpreter and
+of the extractors.
+
+Reads requests from stdin, one JSON object per line:
+
+    {"url": "https://www.youtube.com/watch?v=...", "language": "en"}
+
+"language" is a comma-separated list of languages (regexes, like --sub-lang
+of yt-dlp), the most preferred first. Each request is answered on stdout with
+a line of a status and a length in bytes, followed by that many bytes:
+
+    ok <length>\\n<subtitles as text>
+    error <length>\\n<message>
+    none 0\\n
+
+"none" means the video has no subtitles in any of the languages. Subtitles in
+the first available language are turned into text the same way ytto does
+without a worker. Exits at the end of stdin.
+"""
+
+import json
+import os
+import re
+import sys
+import tempfile
+
+import yt_dlp
+
+TIMESTAMP = re.compile(
+    r"^[0-9][0-9]:[0-9][0-9]:[0-9][0-9].[0-9][0-9][0-9] --> "
+    r"[0-9][0-9]:[0-9][0-9]:[0-9][0-9].[0-9][0-9][0-9]"
+)
+CUE_NUMBER = re.compile(r"^[0-9]{1,3}$")
+TAG = re.compile(r"<[^>]*>")
+BLANK = re.compile(r"^\s*$")
+
+
+class ErrorCollector:
+    """yt-dlp's logger: keeps errors for the answer, drops anything else."""
+
+    def __init__(self):
+        self.errors = []
+
+    def debug(self, msg):
+        pass
+
+    def info(self, msg):
+        pass
+
+    def warning(self, msg):
+        pass
+
+    def error(self, msg):
+        self.errors.append(msg)
+
+
+def vtt_to_text(vtt):
+    """Drops timings, cue numbers, tags, blank lines and the header of WebVTT
+    and joins the rest by spaces, with quotes escaped."""
+    text = []
+    for number, line in enumerate(vtt.split("\n"), start=1):
+        if TIMESTAMP.match(line) or CUE_NUMBER.match(line):
+            continue
+        line = TAG.sub("", line)
+        if BLANK.match(line) or number <= 3:
+            continue
+        text.append(line.replace("'", "\\'").replace('"', '\\"'))
+    return "".join(line + " " for line in text)
+
+
+def preferred_subtitles(requested, languages):
+    """Path of subtitles in the most preferred of languages, None if none."""
+    for language in languages:
+        for available, sub in requested.items():
+            if sub.get("filepath") and re.fullmatch(language, available):
+                return sub["filepath"]
+    return None
+
+
+def fetch(url, language):
+    """(status, payload) of an answer."""
+    languages = [lang for lang in language.split(",") if lang]
+    errors = ErrorCollector()
+    with tempfile.TemporaryDirectory(prefix="ytto-yt-dlp-") as folder:
+        options = {
+            "quiet": True,
+            "noprogress": True,
+            "no_warnings": True,
+            "skip_download": True,
+            "writesubtitles": True,
+            "writeautomaticsub": True,
+            "subtitleslangs": languages,
+            "outtmpl": {"default": os.path.join(folder, "%(id)s.%(ext)s")},
+            "postprocessors": [
+                {
+                    "key": "FFmpegSubtitlesConvertor",
+                    "format": "vtt",
+                    "when": "before_dl",
+                }
+            ],
+            "logger": errors,
+        }
+        try:
+            with yt_dlp.YoutubeDL(options) as ydl:
+                info = ydl.extract_info(url, download=True)
+        except Exception as e:  # pylint: disable=broad-except
+            return "error", "\n".join(errors.errors) or str(e)
+        if errors.errors:
+            return "error", "\n".join(errors.errors)
+
+        requested = (info or {}).get("requested_subtitles") or {}
+        path = preferred_subtitles(requested, languages)
+        if path is None:
+            return "none", ""
+        with open(path, encoding="utf-8") as file:
+            return "ok", vtt_to_text(file.read())
+
+
+def answer(status, payload):
+    data = payload.encode("utf-8", errors="replace")
+    sys.stdout.buffer.write(f"{status} {len(data)}\n".encode("ascii"))
+    sys.stdout.buffer.write(data)
+    sys.stdout.buffer.flush()
+
+
+def main():
+    for line in sys.stdin:
+        if not line.strip():
+            continue
+        try:
+            request = json.loads(line)
+            status, payload = fetch(request["url"], request["language"])
+        except Exception as e:  # pylint: disable=broad-except
+            status, payload = "error", f"Bad request {line.strip()}: {e}"
+        answer(status, payload)
+
+
+if __name__ == "__main__":
+    main()